@@ -3,19 +3,32 @@
 #include "g4-mandatory.hh"
 #include "random/random.hh"
 
+#include "fastsim/light_map.hh"
+#include "fastsim/lxe_light_model.hh"
+#include "geometries/acceptance.hh"
 #include "geometries/compare_scintillators.hh"
+#include "geometries/generate_primaries.hh"
 #include "geometries/imas.hh"
 #include "geometries/jaszczak.hh"
 #include "geometries/nema.hh"
 #include "geometries/samples.hh"
 #include "geometries/sipm.hh"
+#include "io/console_log.hh"
+#include "io/geometry_cache.hh"
+#include "io/job_metrics.hh"
+#include "io/physics_table_cache.hh"
+#include "materials/LXe.hh"
 #include "messengers/abracadabra.hh"
 #include "messengers/density_map.hh"
 #include "messengers/generator.hh"
+#include "utils/keep_largest.hh"
 #include "utils/map_set.hh"
 
 #include <G4ClassificationOfNewTrack.hh>
+#include <G4FastSimulationPhysics.hh>
 #include <G4LogicalVolume.hh>
+#include <G4ProductionCutsTable.hh>
+#include <G4Region.hh>
 #include <G4RunManager.hh>
 #include <G4RunManagerFactory.hh>
 #include <G4StackManager.hh>
@@ -25,14 +38,18 @@
 #include <G4Types.hh>
 #include <G4UIcmdWithAString.hh>
 #include <G4UIExecutive.hh>
+#include <G4Version.hh>
 #include <G4UImanager.hh>
 #include <G4VisExecutive.hh>
 #include <G4VisManager.hh>
 
 #include <G4OpticalPhoton.hh>
+#include <G4Electron.hh>
 #include <G4Gamma.hh>
+#include <G4Positron.hh>
 #include <Randomize.hh>
 
+#include <algorithm>
 #include <cstddef>
 #include <functional>
 #include <chrono>
@@ -40,9 +57,13 @@
 #include <iomanip>
 #include <memory>
 #include <ostream>
+#include <sstream>
 #include <string>
+#include <string_view>
 #include <variant>
 
+#include <sys/resource.h>
+
 using std::make_unique;
 using std::unique_ptr;
 using std::cout;
@@ -50,92 +71,48 @@ using std::endl;
 using std::setw;
 
 namespace report_progress {
-  G4int n_events_requested = 0;
-  std::chrono::steady_clock::time_point events_start;
-  std::function<void(int)> report_event_number = [] (int) {
-    cout << "No user signal event handler has been set so far" << endl;
-  };
-  void signal_handler(int signal) { report_event_number(signal); }
-  void print_vertex(size_t event_id, G4int id, G4int parent,
-                    G4double x, G4double y, G4double z, G4double r,
-                    G4double moved, G4double pre_KE, G4double pst_KE, G4double dep_E,
-                    G4String const& process_name, G4String const& volume_name,
-                    size_t& header_last_printed, bool& track_1_printed_this_event) {
-    if (event_id != header_last_printed) {
-      cout << "   event  parent  id            x    y    z     r     moved    preKE pstKE  dKE   deposited"
-           << endl;
-      header_last_printed = event_id;
-      track_1_printed_this_event = false;
-    }
-
-    if (id == 1 && ! track_1_printed_this_event) {
-      track_1_printed_this_event = true;
-      cout << endl;
-    }
+  auto program_start = std::chrono::steady_clock::now();
+  // On SIGUSR1, printed by the metrics publisher thread
+  void print_event_number(job_stats_t const& stats) {
+    auto n = stats.events;
+    auto N = stats.events_requested;
+    auto fraction = static_cast<float>(n) / N;
+    auto seconds = stats.run_seconds;
+    auto eta = static_cast<unsigned>(seconds / fraction - seconds);
+    auto eta_hours   =  eta / 3600;
+    auto eta_minutes = (eta % 3600) / 60;
+    auto eta_seconds =  eta %   60;
 
-    #define SETW(w,v) setw(w) << v
-    #define ROUND(p,v) std::setw(p) << (int) std::round(v)
-    cout << std::setprecision(1) << std::fixed;
-    cout << SETW(9, event_id)
-         << SETW(5, parent) << ' '
-         << SETW(5, id)
-         << SETW(6, process_name)
-         << "  ("
-         << ROUND(5,x) << ROUND(5,y) << ROUND(5,z) << " :" << ROUND(4,r)
-         << ") "
-         << SETW(7, moved) << "   "
-         << SETW(6, pre_KE)
-         << SETW(6, pst_KE)
-         << SETW(6, pre_KE-pst_KE)
-         << SETW(6, dep_E)
-         << SETW(14, volume_name) << ' '
-         << endl;
-    #undef ROUND
-    #undef SETW
+    std::ostringstream line;
+    line << "Processing event number " << n << " / " << N
+         << std::setprecision(1) << std::fixed << " ("  << 100 * fraction << " %)"
+         << " after " << seconds << " s. ETA: "
+         << eta_hours << "h " << eta_minutes << "m " << eta_seconds << "s, "
+         << stats.events_per_second << " events/s, "
+         << std::setprecision(0) << stats.steps_per_second << " steps/s\n";
+    cout << line.str() << std::flush;
+  }
+  // Time and peak memory up to the start of the first run, which includes
+  // building the geometry and physics tables: compare physics lists with
+  // /abracadabra/physics
+  G4double print_initialization(G4String const& physics) {
+    std::chrono::duration<double> elapsed_seconds = std::chrono::steady_clock::now() - program_start;
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    cout << "Initialization with " << physics << " physics: "
+         << std::setprecision(1) << std::fixed << elapsed_seconds.count() << " s, peak RSS "
+         << usage.ru_maxrss / 1024.0 << " MB" << endl; // ru_maxrss is in kB
+    return elapsed_seconds.count();
   }
 
 }
 
+#include <memory_resource>
 #include <set>
-using times_set = std::multiset<double>;
-
-// NB: I can't help feeling that we're reinventing a wheel that HDF5 should
-// already be implementing for us, but I haven't managed to find it in the
-// documentation:
-
-// Some of our HDF5 tables need to store strings whose values repeat many times.
-// For example, we expect only 3 different processes at our LXe vertices (Rayl,
-// compt, phot), but they will be stored *many* times. Similarly, the name of
-// the volume in which a step terminates, can take on a limited number of
-// values, but will be recorded in each vertex. Rather storing a copy each time,
-// it's much more memory-efficient to store each name once, along with a unique
-// identifier int, and store that int instead of the string itself. For this we
-// need a utility which can tell us the id of any such string, creating new ids
-// on the fly, for values we haven't seen before, and retrieving the already
-// assigned ids of values that we have seen before.
-template<class T>
-class id_store {
-public:
-  id_store(const std::initializer_list<T>& data) { for (auto& item : data) { id(item); } }
-  size_t id(const T& item) {
-    auto found = ids.find(item);
-    if (found != ids.end()) { // Known item: return its id
-      return found->second;
-    } else { // New item: insert into store and return new id
-      auto this_id = items.size();
-      ids.insert({item, this_id});
-      items.push_back(item);
-      return this_id;
-    }
-  }
-  const std::vector<T>& items_ordered_by_id() const { return items; }
-private:
-  std::map<T, size_t> ids;
-  std::vector<T> items;
-};
+using times_set = std::pmr::multiset<double>;
 
-unique_ptr<id_store<std::string>> make_volume_names(std::string scintillator_name) {
-  return unique_ptr<id_store<std::string>>{new id_store<std::string> {
+unique_ptr<n4::id_store> make_volume_names(std::string scintillator_name) {
+  return unique_ptr<n4::id_store>{new n4::id_store{
   scintillator_name, // Ensure that scintillator has id 0: the rest in inside-out order
   "Cavity", "Steel_0", "Inner_vacuum", "Steel_1", "Quartz","Outer_vacuum", "Steel_2",
   // NEMA7 phantom parts (Source_N also used by NEMA3)
@@ -204,31 +181,37 @@ struct phantom_t {
   const n4::geometry::construct_fn geometry;
 };
 
-G4LogicalVolume* find_scintillator_layer(G4String& scint_name) {
-  auto scint = n4::find_logical(scint_name);
-    if (scint) { return scint; }
+G4LogicalVolume* find_scintillator_layer(n4::geometry_catalogue const& catalogue, G4String const& scint_name) {
+  auto& scint = catalogue.named(scint_name);
+    if (! scint.empty()) { return catalogue[scint.front()].logical; }
   FATAL("Couldn't find scintillator layer");
   return nullptr;
 }
 
-// Find the inner and outer radii of the scintillator layer. Assumes that the
-// scintillator layer's first daughter defines its inner radius. Will crash if
-// no daughter present.
-std::tuple<G4double, G4double> find_scintillator_inner_and_outer_radii(G4String& scint_name) {
-  auto scint = find_scintillator_layer(scint_name);
-  auto inner = scint -> GetDaughter(0) -> GetLogicalVolume();
-  auto solid_x = scint -> GetSolid();
-  auto solid_s = inner -> GetSolid();
-  auto tubs_x = dynamic_cast<G4Tubs*>(solid_x);
-  auto tubs_s = dynamic_cast<G4Tubs*>(solid_s);
+// Find the inner and outer radii of the scintillator layer. Unless the layer is
+// an annular shell (flat_layers), assumes that the scintillator layer's first
+// daughter defines its inner radius. Will crash if no daughter present.
+std::tuple<G4double, G4double> find_scintillator_inner_and_outer_radii(n4::geometry_catalogue const& catalogue, G4String const& scint_name) {
+  auto scint = find_scintillator_layer(catalogue, scint_name);
+  auto tubs_x = dynamic_cast<G4Tubs*>(scint -> GetSolid());
   auto scint_R =  tubs_x -> GetOuterRadius();
-  auto scint_r =  tubs_s -> GetOuterRadius();
+  auto scint_r =  tubs_x -> GetInnerRadius();
+  if (scint_r == 0) {
+    auto inner   = scint -> GetDaughter(0) -> GetLogicalVolume();
+    auto tubs_s  = dynamic_cast<G4Tubs*>(inner -> GetSolid());
+    scint_r = tubs_s -> GetOuterRadius();
+  }
   std::cout << "\n\n\nXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX\n\n\n";
   std::cout << "scintillator radii: " << scint_r << ' ' << scint_R;
   std::cout << "\n\n\nXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX\n\n\n";
   return {scint_r, scint_R};
 }
 
+G4double find_scintillator_half_length(n4::geometry_catalogue const& catalogue, G4String const& scint_name) {
+  auto scint = find_scintillator_layer(catalogue, scint_name);
+  return dynamic_cast<G4Tubs*>(scint -> GetSolid()) -> GetZHalfLength();
+}
+
 // ============================== MAIN =======================================================
 int main(int argc, char** argv) {
 
@@ -236,28 +219,16 @@ int main(int argc, char** argv) {
   auto current_event = [&]() { return n4::event_number() + messenger.offset; };
 
 
-  report_progress::report_event_number = [&](int) {
-    auto n = n4::event_number();
-    auto N = report_progress::n_events_requested;
-    auto fraction = static_cast<float>(n) / N;
-    auto now = std::chrono::steady_clock::now();
-    std::chrono::duration<double> elapsed_seconds = now - report_progress::events_start;
-    auto seconds = elapsed_seconds.count();
-    auto eta = static_cast<unsigned>(seconds / fraction - seconds);
-    auto eta_hours   =  eta / 3600;
-    auto eta_minutes = (eta % 3600) / 60;
-    auto eta_seconds =  eta %   60;
-
-    cout << "Processing event number " << n << " / " << N
-         << std::setprecision(1) << std::fixed << " ("  << 100 * fraction << " %)"
-         << " after " << seconds << " s. ETA: "
-         << eta_hours << "h " << eta_minutes << "m " << eta_seconds << "s\n";
-  };
-  std::signal(SIGUSR1, report_progress::signal_handler);
+  // ----- Live metrics: published to a memory-mapped file, and on SIGUSR1 ----------------
+  job_metrics metrics;
+  unique_ptr<metrics_publisher> publisher; // Started with the first run, once the macros have been read
+  std::signal(SIGUSR1, metrics_publisher::request_report);
 
 
   // ----- collecting arrival times of optical photons in sensors ----------------------------
-  std::map<size_t, times_set> times;
+  // Allocated from memory which is recycled at the start of each event
+  n4::event_arena event_memory;
+  std::pmr::map<size_t, times_set> times{event_memory.resource()};
 
   auto add_to_waveforms = [&times](auto sensor_id, auto time) {
     if (!contains(times, sensor_id)) {
@@ -272,33 +243,65 @@ int main(int argc, char** argv) {
   auto open_writer = [&writer, &messenger]() { writer.reset(new hdf5_io{messenger.outfile});};
 
   // ----- Extract sensor positions from geometry and write to hdf5 --------------------------
-  auto write_sensor_database = [&writer, &open_writer](auto geometry) {
+  auto write_sensor_database = [&writer, &open_writer](n4::geometry_catalogue const& catalogue) {
     open_writer();
-    for(auto* vol: geometry) {
-       auto name = vol -> GetName();
-      if (name.rfind("Hamamatsu_Blue", 0) == 0) { // starts with
-        auto p = vol -> GetTranslation();
-        auto id = vol -> GetCopyNo();
-        writer -> write_sensor_xyz(id, p.x(), p.y(), p.z());
-      }
+    // Every placement of every tile, whichever logical volume it comes from
+    auto& tiles = catalogue.named("Hamamatsu_Blue");
+    if (tiles.empty()) { FATAL("No Hamamatsu_Blue tiles for the sensor database"); }
+    for (auto index : tiles) {
+      auto p = catalogue[index].position();
+      writer -> write_sensor_xyz(sipm_sensor_id(catalogue, index), p.x(), p.y(), p.z());
     }
-    return geometry;
   };
 
+  // Indexed view of the whole geometry, built once it is complete
+  unique_ptr<n4::geometry_catalogue> catalogue;
+
   // ----- Sensitive detector ----------------------------------------------------------------
   auto trigger_time = std::numeric_limits<G4double>::infinity();
-  n4::sensitive_detector::process_hits_fn store_hits = [&add_to_waveforms, &trigger_time](G4Step* step) {
+
+  // Photons arriving more than `acquisition_window` after the first sensor hit
+  // (trigger_time) are discarded by write_hits. As trigger_time can only
+  // decrease during an event, any optical photon whose global time already
+  // exceeds this limit can never be recorded, so we may stop tracking it.
+  auto too_late = [&trigger_time, &messenger](G4double time) {
+    return time - trigger_time > messenger.acquisition_window * ns;
+  };
+  // With messenger.pde_at_creation, optical photons are thinned at creation by
+  // the maximum PDE (kill_or_wait_secondaries), and the wavelength-dependent
+  // remainder is applied on detection (store_hits). The product is the exact
+  // per-wavelength PDE, so the statistics of detected photons are those of
+  // applying the PDE in post-processing.
+  auto& pde = hamamatsu_blue_pde();
+
+  auto record_photon = [&](auto sensor_id, auto time) {
+    job_metrics::bump(metrics.optical_detected);
+    add_to_waveforms(sensor_id, time);
+    trigger_time = std::min(trigger_time, time);
+  };
+
+  // ----- Light maps: generating them, or using them instead of optical photons ---------
+  // Generating: each event emits photons from one voxel, whose detected photons
+  // are accumulated into the map, rather than being written out as waveforms.
+  // Using: see lxe_light_model, which feeds record_photon.
+  unique_ptr<light_map> light_map_in_use, light_map_being_built;
+  unique_ptr<lxe_light_model> light_model; // Uses light_map_in_use: both live until the end of the job
+  size_t light_map_voxel; // Source of photons in current event, when generating
+
+  // Inner and outer radii, and half-length of the scintillator layer
+  G4double scint_r, scint_R, scint_half_z; // Initialized in start_run
+
+  n4::sensitive_detector::process_hits_fn store_hits = [&](G4Step* step) {
     static auto optical_photon = G4OpticalPhoton::Definition();
 
     auto track    = step -> GetTrack();
     auto particle = track -> GetParticleDefinition();
-    auto name     = particle -> GetParticleName();
 
     if (particle == optical_photon) {
+      if (messenger.pde_at_creation && ! pde.detected_after_thinning(track)) { return false; }
       auto time = track -> GetGlobalTime();
-      auto sensor_id = step -> GetPreStepPoint() -> GetTouchable() -> GetCopyNumber(1);
-      add_to_waveforms(sensor_id, time);
-      trigger_time = std::min(trigger_time, time);
+      auto sensor_id = sipm_sensor_id(step -> GetPreStepPoint() -> GetTouchable());
+      record_photon(sensor_id, time);
       return true;
     }
 
@@ -306,12 +309,22 @@ int main(int argc, char** argv) {
   };
 
   n4::sensitive_detector::end_of_event_fn write_hits = [&](auto) {
-    const auto acquisition_widow = 500 * ns;
+    if (light_map_being_built) {
+      for (auto& [sensor_id, ts] : times) {
+        for (auto t : ts) {
+          if (too_late(t)) { break; }
+          light_map_being_built -> detected(light_map_voxel, sensor_id, t);
+        }
+      }
+      times.clear();
+      return;
+    }
     size_t event_id = current_event();
+    std::pmr::vector<f16> tvec{event_memory.resource()};
     for (auto& [sensor_id, ts] : times) {
-      std::vector<float> tvec;
+      tvec.clear();
       for (auto t : ts) {
-        if (t - trigger_time > acquisition_widow) { break; }
+        if (too_late(t)) { break; }
         tvec.push_back(t);
       }
       if ( ! tvec.empty()) {
@@ -362,6 +375,7 @@ int main(int argc, char** argv) {
       .sphereD(28*mm, 4)
       .sphereD(37*mm, 4)
       .vacuum_body(messenger.vacuum_phantom)
+      .extruded_body(messenger.extruded_nema_7)
       .build();
   };
 
@@ -385,6 +399,7 @@ int main(int argc, char** argv) {
   // `polymorphic_phantom`.
   auto phantom_geometry = [&phantom](          ) { return std::visit([     ](auto& ph) { return ph.geometry          (     ); }, phantom); };
   auto phantom_generate = [&phantom](auto event) { return std::visit([event](auto& ph) { return ph.generate_primaries(event); }, phantom); };
+  auto phantom_vertex   = [&phantom](          ) { return std::visit([     ](auto& ph) { return ph.generate_vertex   (     ); }, phantom); };
 
   // Choose phantom in config file via `/abracadabra/phantom`
   auto set_phantom = [&](G4String p) {
@@ -399,25 +414,35 @@ int main(int argc, char** argv) {
 
   // Name of the scintillator material and its volumes
   G4String scint_name; // Will be set when `detector()` is executed
+  std::vector<G4LogicalVolume*> scint_volumes; // All parts of the scintillator, set with the geometry
+
+  n4::id_store process_names{"compt", "phot", "Rayl"};
+  unique_ptr<n4::id_store> volume_names;
+  // Settings implied by the choice of detector: needed whether the detector is
+  // built, or loaded from the geometry cache
+  auto choose_scintillator = [&, &d = messenger.detector]() {
+    if (d == "scintillator" && messenger.magic_level < 1) { messenger.magic_level = 1; }
+    scint_name = (d != "scintillator") ? "LXe" : messenger.scintillator;
+    volume_names = make_volume_names(scint_name);
+  };
 
-  id_store<std::string> process_names{{"compt", "phot", "Rayl"}};
-  unique_ptr<id_store<std::string>> volume_names;
   // ----- Available detector geometries -------------------------------------------------
   // Can choose detector in macros with `/abracadabra/detector <choice>`
   auto detector = [&, &d = messenger.detector]() -> G4VPhysicalVolume* {
-    if (d == "scintillator" && messenger.magic_level < 1) { messenger.magic_level = 1; }
+    choose_scintillator();
     auto dr_sci = messenger.scintillator_thickness  * mm;
     auto dr_Qtz = messenger.quartz_thickness        * mm;
     auto length = messenger.cylinder_length         * mm;
     auto radius = messenger.cylinder_radius         * mm;
     auto clear  = messenger.steel_is_vacuum;
+    auto reps   = messenger.replicated_sipms;
+    auto flat   = messenger.flat_layers;
     auto magic  = messenger.magic_level;
-    auto scint  = (d != "scintillator") ? "LXe" : messenger.scintillator; scint_name = scint;
-    volume_names = make_volume_names(scint_name);
+    auto scint  = scint_name;
     return
-      d == "scintillator" ? compare_scintillators(scint  , length, radius, dr_sci)     :
+      d == "scintillator" ? compare_scintillators(scint  , length, radius, dr_sci, flat) :
       d == "cylinder"     ? cylinder_lined_with_hamamatsus(length, radius, dr_sci, sd) :
-      d == "imas"         ? imas_demonstrator(sd, length, dr_Qtz, dr_sci, clear)       :
+      d == "imas"         ? imas_demonstrator(sd, length, dr_Qtz, dr_sci, clear, reps, flat) :
       magic >= 3          ? magic_detector()                                           :
       d == "square"       ? square_array_of_sipms(sd)                                  :
       d == "hamamatsu"    ? nain4::place(sipm_hamamatsu_blue(true, sd)).now()          :
@@ -434,11 +459,91 @@ int main(int argc, char** argv) {
       (FATAL(("Unrecoginzed geometry: " + g).c_str()), nullptr);
   };
 
+  // ----- Reuse the geometry of an earlier job with the same parameters, if possible
+  // Enable in macros with `/abracadabra/geometry_cache <directory>`
+  auto geometry_cache_key = [&messenger]() {
+    auto& m = messenger;
+    std::ostringstream key;
+    key << m.geometry << ' ' << m.detector << ' ' << m.phantom << ' ' << m.scintillator
+        << ' ' << m.quartz_thickness << ' ' << m.scintillator_thickness
+        << ' ' << m.cylinder_length  << ' ' << m.cylinder_radius
+        << ' ' << m.steel_is_vacuum  << ' ' << m.flat_layers << ' ' << m.magic_level
+        << ' ' << m.vacuum_phantom   << ' ' << m.extruded_nema_7
+        << ' ' << m.nema5_sleeves    << ' ' << m.y_offset << ' ' << m.z_offset
+        << ' ' << G4VERSION_NUMBER;
+    return key.str();
+  };
+
+  // ----- Independent production cuts for phantom, passive layers and scintillator -------
+  // Set in macros with `/abracadabra/cut_{phantom,passive,scintillator} <mm>`: 0 keeps the default
+  auto set_production_cuts = [&](G4VPhysicalVolume* world) {
+    auto& m = messenger;
+    // Region created by combine_geometries (or recorded in the geometry cache);
+    // on its own, the phantom is the only daughter of its envelope
+    if (m.geometry == "phantom") {
+      n4::region("Phantom").add(world -> GetLogicalVolume() -> GetDaughter(0) -> GetLogicalVolume()).now();
+    }
+    auto phantom = n4::find_region("Phantom", false);
+    if (m.cut_phantom > 0 && ! phantom) { FATAL("/abracadabra/cut_phantom: the geometry has no Phantom region"); }
+    if      (m.cut_phantom > 0) { n4::region("Phantom").cut(m.cut_phantom * mm).now(); }
+    else if (phantom) { // The live defaults, not any cuts recorded in the geometry cache
+      phantom -> SetProductionCuts(G4ProductionCutsTable::GetProductionCutsTable() -> GetDefaultProductionCuts());
+    }
+    if (m.geometry == "phantom") { return; }
+    if (m.cut_passive > 0 || m.cut_scintillator > 0) {
+      set_detector_production_cuts(world, scint_name, m.cut_passive * mm, m.cut_scintillator * mm);
+    }
+  };
+
+  // ----- What a world loaded from the geometry cache lacks -------------------------------
+  // Regions, fast simulation models and cuts are applied in the geometry
+  // initialization below, whichever way the world was obtained
+  auto reattach_after_load = [&](G4VPhysicalVolume* world) {
+    if (messenger.geometry != "phantom") { choose_scintillator(); } // Normally done by detector()
+    attach_sensitive_detector(world, "pre_Quartz_window", sd);     // GDML does not record SDs
+  };
+
+  auto cached_geometry = [&]() -> G4VPhysicalVolume* {
+    auto& directory = messenger.geometry_cache;
+    // GDML cannot reproduce the custom parameterisation of the SiPM columns
+    auto replicas = messenger.replicated_sipms && messenger.detector == "imas" && messenger.geometry != "phantom";
+    if (directory.empty() || replicas) { return geometry(); }
+
+    auto file = geometry_cache_file(directory, geometry_cache_key());
+    if (auto world = load_geometry_cache(file)) {
+      std::cout << "Geometry loaded from cache: " << file << std::endl;
+      reattach_after_load(world);
+      return world;
+    }
+    auto world = geometry();
+    set_production_cuts(world); // Regions complete before GDML records them; set again below, harmlessly
+    save_geometry_cache(file, world);
+    std::cout << "Geometry written to cache: " << file << std::endl;
+    return world;
+  };
+
   // ----- A choice of generators ---------------------------------------------------------
   // Can choose generator in macros with `/abracadabra/generator <choice>`
+  size_t vertices_outside_acceptance; // In the current run, with acceptance_filter
   std::map<G4String, n4::generator::function> generators = {
     {"origin"      , [ ](auto event) { generate_back_to_back_511_keV_gammas(event, {}, 0); }},
-    {"phantom"     , [&](auto event) { phantom_generate(event); }},
+    {"phantom"     , [&](auto event) {
+      if (! messenger.acceptance_filter) { phantom_generate(event); return; }
+      // Pairs which cannot reach the scintillator are never generated: the
+      // fraction that could is recorded as the event's weight. Vertices from
+      // which none could are drawn again, and counted in the run info.
+      auto vertex = phantom_vertex();
+      auto weight = back_to_back_acceptance(vertex, scint_r, scint_half_z);
+      for (auto redrawn=0; weight <= 0; ++redrawn) {
+        if (redrawn == 1000) { FATAL("No phantom vertices within the acceptance of the scintillator"); }
+        vertices_outside_acceptance++;
+        vertex = phantom_vertex();
+        weight = back_to_back_acceptance(vertex, scint_r, scint_half_z);
+      }
+      auto direction = random_accepted_direction(vertex, scint_r, scint_half_z);
+      generate_back_to_back_511_keV_gammas(event, vertex, 0, direction);
+      writer -> write_weight(current_event(), weight);
+    }},
     {"quarter_ring", [ ](auto event) {
       // Lots of asymmetry to help verify orientation
       auto r = 250 * mm;
@@ -447,6 +552,24 @@ int main(int argc, char** argv) {
       auto y = r * sin(phi);
       auto z = 100  * mm;
       generate_back_to_back_511_keV_gammas(event, {x,y,z}, 0);
+    }},
+    // Successive events cycle through the voxels: split generation among jobs
+    // with /abracadabra/event_number_offset
+    {"light_map"   , [&](auto event) {
+      if (! light_map_being_built) {
+        // The map records the detection efficiency of untouched optical photons
+        if (messenger.pde_at_creation) { FATAL("Light maps cannot be generated with /abracadabra/pde_at_creation"); }
+        auto& bins = messenger.light_map_bins;
+        light_map_being_built = make_unique<light_map>(light_map::binning{
+            static_cast<u32>(bins.x()), static_cast<u32>(bins.y()), static_cast<u32>(bins.z()),
+            scint_r, scint_R, scint_half_z});
+      }
+      auto& map = *light_map_being_built;
+      auto n_photons  = messenger.light_map_photons;
+      light_map_voxel = current_event() % map.n_voxels();
+      map.emitted(light_map_voxel, n_photons);
+      generate_optical_photons(event, map.random_point_in(light_map_voxel), 0,
+                               n_photons, LXe_random_scintillation_energy);
     }}
   };
 
@@ -456,7 +579,16 @@ int main(int argc, char** argv) {
   set_phantom(messenger.phantom);
 
   // ----- Identifying vertices in LXe ----------------------------------------------------
-  auto transp = [](auto name) { return name == "Transportation" ? "---->" : name; };
+  // Views of the process's own name: no string is built on each step
+  auto transp = [](auto const& name) { return name == "Transportation" ? std::string_view{"---->"} : std::string_view{name}; };
+  // Parts of the scintillator with names of their own (the ring holding
+  // replicated SiPMs) are reported as the scintillator itself
+  auto volume_name_of = [&](G4VPhysicalVolume const* volume) -> std::string_view {
+    if (! volume) { return "None"; }
+    auto logical = volume -> GetLogicalVolume();
+    if (std::find(begin(scint_volumes), end(scint_volumes), logical) != end(scint_volumes)) { return scint_name; }
+    return volume -> GetName();
+  };
 
   // If messenger.E_cut is set, save time by not simulating secondaries for
   // events in which a gamma's energy falls below the cut, before entering LXe.
@@ -469,19 +601,77 @@ int main(int argc, char** argv) {
   // can skip the secondaries.
   bool detected_gamma_1, detected_gamma_2;
 
-  // Inner and outer radii of the scintillator layer
-  G4double scint_r, scint_R; // Initialized in start_run
+  // Similarly, events in which the gammas lose too little energy in LXe will
+  // fall outside of the photopeak, and be rejected (messenger.E_min_gamma and
+  // E_min_total). Energy lost by each gamma in LXe during stage 1, in keV: it
+  // ends up being deposited by the secondaries.
+  G4double E_in_scint_gamma_1, E_in_scint_gamma_2;
+
+  // Bookkeeping of optical photons which were stopped because they could no
+  // longer arrive within the acquisition window.
+  struct {
+    size_t killed_at_birth = 0, killed_in_flight = 0, steps_before_kill = 0;
+  } late_photons;
+
+  // ----- Per-event cost profiling ---------------------------------------------------------
+  // Enable in macros with `/abracadabra/event_cost true`: one row per event in
+  // MC/event_cost. With `/abracadabra/slowest_events N`, the random engine
+  // state at the start of the N slowest events of each run is also saved, so
+  // they can be replayed on their own with /random/resetEngineFrom.
+  struct {
+    event_cost_t row;
+    std::chrono::steady_clock::time_point start;
+    engine_state rng;
+  } event_cost;
+  keep_largest<std::pair<size_t, engine_state>> slowest_events{0}; // Sized in start_run
+
+  // Before any random numbers are used for the event
+  auto generate_primaries = [&, generate = generator_messenger.generator()](G4Event* event) {
+    if (messenger.event_cost && messenger.slowest_events > 0) { event_cost.rng = current_engine_state(); }
+    if (messenger.event_cost) { event_cost.start = std::chrono::steady_clock::now(); }
+    generate(event);
+  };
 
-  n4::stepping_action::action_t stepping_action = [&](auto step) {
-    static size_t header_last_printed = 666;
-    static bool track_1_printed_this_event = false;
+  // Verbose event and vertex printing is formatted and written on a separate
+  // thread, so that the terminal does not slow down the simulation
+  console_log console;
+
+  // The hottest code in the program: not wrapped in a std::function (see stepping_action_t)
+  auto stepping_action = [&](G4Step const* step) {
+    static auto OPTICAL_PHOTON = G4OpticalPhoton::Definition();
+    job_metrics::bump(metrics.steps);
 
     auto pst_pt = step -> GetPostStepPoint();
     auto pre_pt = step -> GetPreStepPoint();
 
     auto track = step -> GetTrack();
+
+    // ----- Optical photons: never recorded as vertices, stopped once they are too late
+    if (messenger.event_cost) {
+      static auto GAMMA = G4Gamma::Definition(), ELECTRON = G4Electron::Definition(), POSITRON = G4Positron::Definition();
+      auto particle = track -> GetParticleDefinition();
+      auto& row = event_cost.row;
+      ++(particle == OPTICAL_PHOTON ? row.steps_optical  :
+         particle == GAMMA          ? row.steps_gamma    :
+         particle == ELECTRON       ? row.steps_electron :
+         particle == POSITRON       ? row.steps_positron :
+                                      row.steps_other    );
+    }
+
+    if (track -> GetParticleDefinition() == OPTICAL_PHOTON) {
+      if (track -> GetCurrentStepNumber() == 1) { job_metrics::bump(metrics.optical_tracked); }
+      if (messenger.kill_late_photons                          &&
+          track -> GetTrackStatus() == G4TrackStatus::fAlive   &&
+          too_late(track -> GetGlobalTime())) {
+        track -> SetTrackStatus(G4TrackStatus::fStopAndKill);
+        late_photons.killed_in_flight  += 1;
+        late_photons.steps_before_kill += track -> GetCurrentStepNumber();
+      }
+      return;
+    }
+
     auto process_name    = transp(pst_pt -> GetProcessDefinedStep() -> GetProcessName());
-    G4String volume_name;
+    std::string_view volume_name; // See volume_name_of: compared with scint_name for membership
 
     const auto GAMMA = G4Gamma::Definition();
 
@@ -490,13 +680,12 @@ int main(int argc, char** argv) {
       // Only record vertices (not transport) of gammas
       auto particle = track -> GetParticleDefinition();
       if (particle != GAMMA || process_name == "---->") return;
-      volume_name = pst_pt -> GetPhysicalVolume() -> GetName();
+      volume_name = volume_name_of(pst_pt -> GetPhysicalVolume());
     } else {
       // ----- Magic LXe detector --------------------------------------------------------------------
       // 1. Immediately stop any particle that reaches LXe.
       // 2. Record only (a) gammas (b) which have reached LXe
-      auto pst_physvol = pst_pt -> GetPhysicalVolume();
-      volume_name = pst_physvol ? pst_physvol -> GetName() : "None";
+      volume_name = volume_name_of(pst_pt -> GetPhysicalVolume());
       // Stop as soon as LXe reached
       if (volume_name == scint_name) { track -> SetTrackStatus(G4TrackStatus::fStopAndKill); }
       // Write only gammas entering LXe (not expecting anything other than gamma, before LXe)
@@ -523,16 +712,17 @@ int main(int argc, char** argv) {
     if (r < scint_r) {
       lowest_pre_LXe_gamma_energy_in_event = std::min(lowest_pre_LXe_gamma_energy_in_event, pst_KE);
       if (messenger.verbosity > 3) {
+        console.flush();
         std::cout << " gamma low: " << lowest_pre_LXe_gamma_energy_in_event << std::endl;
       }
     } else if (volume_name == scint_name) {
-      if (id == 1) { detected_gamma_1 = true; }
-      if (id == 2) { detected_gamma_2 = true; }
+      if (id == 1) { detected_gamma_1 = true; E_in_scint_gamma_1 += pre_KE - pst_KE; }
+      if (id == 2) { detected_gamma_2 = true; E_in_scint_gamma_2 += pre_KE - pst_KE; }
     }
 
     // Process and volume ids
-    auto  volume_id =  volume_names -> id( volume_name);
-    auto process_id = process_names .  id(process_name);
+    auto  volume_id =  volume_names -> id(pst_pt -> GetPhysicalVolume()    ,  volume_name);
+    auto process_id = process_names .  id(pst_pt -> GetProcessDefinedStep(), process_name);
 
     // Write vertex to output file
     writer -> write_vertex(       event_id, id, parent, x,y,z,t, moved, pre_KE, pst_KE, dep_E,
@@ -540,22 +730,33 @@ int main(int argc, char** argv) {
 
     // Live progress report on stdout
     if (messenger.verbosity < 2) return;
-    report_progress::print_vertex(event_id, id, parent, x,y,z,r, moved, pre_KE, pst_KE, dep_E,
-                                  process_name, volume_name,
-                                  header_last_printed, track_1_printed_this_event);
+    console_log::vertex v{event_id, id, parent, x,y,z,r, moved, pre_KE, pst_KE, dep_E, {}, {}};
+    console_log::copy_name(v.process, process_name);
+    console_log::copy_name(v.volume ,  volume_name);
+    console.log(v);
   };
 
+  // ----- Stepping profiler: time and steps per volume, process and particle --------------
+  // Enable in macros with `/abracadabra/step_profile N` (time every Nth step).
+  // Installed in place of the plain stepping action at the start of the first
+  // run, so that without it nothing is added to the hottest code.
+  unique_ptr<n4::step_profiler> step_profiler;
+  G4UserSteppingAction* plain_stepping_action; // Set with the other user actions
+
   // BeginOfEvent action:
-  // 1. Resets lowest gamma energy bookkeeping
+  // 1. Resets event bookkeeping, and recycles per-event memory
   // 2. Writes the primary vertex of the event to HDF5
   n4::event_action::action_t begin_event = [&](auto event) {
     // Reset event bookkeeping
+    times.clear(); // Normally already done by write_hits
+    event_memory.reset();
     lowest_pre_LXe_gamma_energy_in_event = 511.0;
     trigger_time                         = std::numeric_limits<G4double>::infinity();
     detected_gamma_1 = false;
     detected_gamma_2 = false;
+    E_in_scint_gamma_1 = 0;
+    E_in_scint_gamma_2 = 0;
     // Write primary vertex
-    using std::setw;
     auto event_id = current_event();
     auto vertex = event -> GetPrimaryVertex();
     auto pos = vertex -> GetPosition();
@@ -563,40 +764,135 @@ int main(int argc, char** argv) {
     auto [ x, y, z] = std::make_tuple(pos.x(), pos.y(), pos.z());
     auto [px,py,pz] = std::make_tuple(mom.x(), mom.y(), mom.z());
     writer -> write_primary(event_id, x,y,z, px,py,pz);
+    event_cost.row = {};
+    event_cost.row.event_id = event_id;
     if (messenger.verbosity < 1) { return; }
-    if (messenger.verbosity < 2) {
-      cout << std::setprecision(1) << std::fixed;
-      cout << setw(9) << event_id << endl;
-      return;
+    console.log(console_log::primary{event_id, messenger.verbosity < 2, x,y,z, px,py,pz});
+  };
+
+  n4::event_action::action_t end_event = [&](auto) {
+    job_metrics::bump(metrics.events);
+    if (! messenger.event_cost) { return; }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - event_cost.start;
+    event_cost.row.seconds = elapsed.count();
+    writer -> write_event_cost(event_cost.row);
+    if (slowest_events.would_keep(elapsed.count())) {
+      slowest_events.offer(elapsed.count(), {event_cost.row.event_id, std::move(event_cost.rng)});
     }
-    cout << endl << setw(9) << event_id << " -------  "
-         << setw(7) <<  x << setw(7) <<  y << setw(7) <<  z << "     "
-         << setw(7) << px << setw(7) << py << setw(7) << pz
-         << "  --------------------------------" << endl;
   };
 
-  size_t secondaries_no = 0, secondaries_yes = 0;
+  // Why secondaries were ignored: first applicable reason in each event
+  struct {
+    size_t magic = 0, E_cut = 0, undetected = 0, E_min_gamma = 0, E_min_total = 0;
+  } ignored_because;
   n4::run_action::action_t   end_run = [&](auto) {
+    metrics.end_run();
+    console.flush();
+    if (console.dropped()) {
+      std::cout << console.dropped() << " lines of verbose output dropped: the terminal could not keep up\n";
+    }
     writer -> write_strings("process_names", process_names .  items_ordered_by_id());
     writer -> write_strings( "volume_names",  volume_names -> items_ordered_by_id());
+    if (light_map_being_built) { light_map_being_built -> write(*writer); }
+    if (messenger.acceptance_filter) {
+      writer -> write_run_info("vertices_outside_acceptance", std::to_string(vertices_outside_acceptance).c_str());
+    }
+    for (auto& [seconds, event] : slowest_events.sorted()) {
+      auto& [event_id, rng] = event;
+      auto file = messenger.outfile + ".event-" + std::to_string(event_id) + ".rndm";
+      save_engine_state(rng, file);
+      std::cout << "Slow event " << event_id << " (" << std::setprecision(2) << seconds << " s): "
+                << "replay with /random/resetEngineFrom " << file << '\n';
+    }
+    if (step_profiler) {
+      step_profiler -> print(std::cout);
+      for (auto& row : step_profiler -> summary()) {
+        writer -> write_step_profile(row.volume, row.process, row.particle, row.steps, row.timeable, row.sampled, row.seconds());
+      }
+    }
+    auto secondaries_yes = metrics.secondaries_yes.load(), secondaries_no = metrics.secondaries_no.load();
     std::cout << "Scondaries simulated " << secondaries_yes
               << " times, ignored " << secondaries_no << " times (" << std::setprecision(0)
               << 100.0 * secondaries_yes / (secondaries_yes + secondaries_no)<< " %)\n";
+    auto& why = ignored_because;
+    std::cout << "Secondaries ignored because of: "
+              << "magic level "                   << why.magic       << ", "
+              << "E_cut before scintillator "     << why.E_cut       << ", "
+              << "gamma missing scintillator "    << why.undetected  << ", "
+              << "gamma energy in scintillator "  << why.E_min_gamma << ", "
+              << "total energy in scintillator "  << why.E_min_total << '\n';
+    if (messenger.kill_late_photons) {
+      auto& lp = late_photons;
+      std::cout << "Late optical photons (acquisition window " << messenger.acquisition_window << " ns): "
+                << lp.killed_at_birth << " tracks killed at birth, "
+                << lp.killed_in_flight << " stopped in flight after "
+                << lp.steps_before_kill << " steps\n";
+    }
   };
 
+  // ----- Physics tables: retrieved from the cache, or stored in it once built --------------
+  // Enable in macros with `/abracadabra/physics_table_cache <directory>`
+  G4VModularPhysicsList* physics_list = nullptr; // Owned by run_manager
+  std::string physics_table_dir;                 // Set once the geometry exists
+
   n4::run_action::action_t start_run = [&](auto run) {
-    report_progress::events_start = std::chrono::steady_clock::now();
-    report_progress::n_events_requested = run -> GetNumberOfEventToBeProcessed();
-    std::tie(scint_r, scint_R) = find_scintillator_inner_and_outer_radii(scint_name);
+    static bool first_run = true;
+    if (first_run && messenger.step_profile > 0) {
+      step_profiler = make_unique<n4::step_profiler>(messenger.step_profile);
+      run_manager -> SetUserAction(new n4::stepping_action_t{step_profiler -> around(stepping_action)});
+      delete plain_stepping_action; // No longer used by Geant4, which now owns the profiled one
+    }
+    if (step_profiler) { step_profiler -> clear(); }
+    // Volumes and processes may have been rebuilt since the last run
+    process_names.forget_objects();
+    if (volume_names) { volume_names -> forget_objects(); }
+    if (first_run) { metrics.init_seconds = report_progress::print_initialization(messenger.physics); first_run = false; }
+    if (! physics_table_dir.empty() && ! physics_tables_stored(physics_table_dir)) {
+      store_physics_tables(physics_list, physics_table_dir);
+      std::cout << "Physics tables written to cache: " << physics_table_dir << std::endl;
+    }
+    // Downstream analysis must not apply the PDE a second time
+    if (messenger.pde_at_creation) { writer -> write_run_info("sipm_pde", "applied in simulation"); }
+    if (light_map_in_use)          { writer -> write_run_info("scintillation", "sampled from light map"); }
+    vertices_outside_acceptance = 0;
+    if (! publisher) {
+      publisher = make_unique<metrics_publisher>(metrics, messenger.metrics_file, messenger.metrics_interval,
+                                                 report_progress::print_event_number);
+    }
+    metrics.start_run(run -> GetNumberOfEventToBeProcessed());
+    slowest_events = keep_largest<std::pair<size_t, engine_state>>{messenger.event_cost ? messenger.slowest_events : 0};
+    std::tie(scint_r, scint_R) = find_scintillator_inner_and_outer_radii(*catalogue, scint_name);
+    scint_half_z               = find_scintillator_half_length          (*catalogue, scint_name);
   };
 
   // ----- Stacking: Process gammas before secondaries (secondaries only if needed) -------
   unsigned stage; // 1: gammas; 2: secondaries
 
-  n4::stacking_action::classify_t kill_or_wait_secondaries = [&stage, &messenger](auto track) {
+  n4::stacking_action::classify_t kill_or_wait_secondaries = [&stage, &messenger, &too_late, &late_photons, &pde, &event_cost, &console](auto track) {
     const auto NOW  = G4ClassificationOfNewTrack::fUrgent;
     const auto KILL = G4ClassificationOfNewTrack::fKill;
     const auto WAIT = G4ClassificationOfNewTrack::fWaiting;
+    static auto OPTICAL_PHOTON = G4OpticalPhoton::Definition();
+
+    if (messenger.event_cost) {
+      event_cost.row.tracks += 1;
+      if (track -> GetDefinition() == OPTICAL_PHOTON) { event_cost.row.optical_created += 1; }
+    }
+
+    // Optical photons born after the acquisition window has closed need not be tracked at all
+    if (messenger.kill_late_photons                    &&
+        track -> GetDefinition() == OPTICAL_PHOTON     &&
+        too_late(track -> GetGlobalTime())) {
+      late_photons.killed_at_birth += 1;
+      return KILL;
+    }
+
+    // Don't track photons which would not survive the SiPM's maximum PDE
+    if (messenger.pde_at_creation                      &&
+        track -> GetDefinition() == OPTICAL_PHOTON     &&
+        ! pde.survives_creation()) {
+      return KILL;
+    }
 
     const bool verbose = messenger.verbosity > 4;
     auto  vNOW = [=] { if (verbose) {std::cout <<  "NOW\n";} return  NOW; };
@@ -605,6 +901,7 @@ int main(int argc, char** argv) {
 
     if (stage == 1) { // primary gammas only, delay secondaries
       if (verbose) {
+        console.flush(); // Keep the order of verbose output
         std::cout << track -> GetParentID() << " -> " << track -> GetTrackID() << ' '
           << track -> GetDefinition() -> GetParticleName() << "     ";
       }
@@ -626,16 +923,25 @@ int main(int argc, char** argv) {
   n4::stacking_action::stage_t forget_or_track_secondaries = [&] (G4StackManager * const stack_manager) {
     stage++;
     if (stage == 2) {
-      bool ignore_secondaries = messenger.magic_level                > 0               ||
-                                lowest_pre_LXe_gamma_energy_in_event < messenger.E_cut ||
-                                ! detected_gamma_1 || ! detected_gamma_2;
+      auto& why = ignored_because;
+      auto E_1 = E_in_scint_gamma_1, E_2 = E_in_scint_gamma_2;
+      // Only the first applicable reason is counted
+      bool ignore_secondaries = true;
+      if      (messenger.magic_level                > 0                    ) { ++why.magic;       }
+      else if (lowest_pre_LXe_gamma_energy_in_event < messenger.E_cut      ) { ++why.E_cut;       }
+      else if (! detected_gamma_1 || ! detected_gamma_2                    ) { ++why.undetected;  }
+      else if (std::min(E_1, E_2)                   < messenger.E_min_gamma) { ++why.E_min_gamma; }
+      else if (E_1 + E_2                            < messenger.E_min_total) { ++why.E_min_total; }
+      else                                                                   { ignore_secondaries = false; }
       if (messenger.verbosity > 2) {
+        console.flush();
         std::cout << "\nignore secondaries: " << (ignore_secondaries ? "YES" : "NO ") << "   "
                   << lowest_pre_LXe_gamma_energy_in_event << " <? " << messenger.E_cut
                   << "   gammas detected: " << std::boolalpha << detected_gamma_1 << ' ' <<  detected_gamma_2
+                  << "   E in scintillator: " << E_1 << " + " << E_2
                   << "\n\n";}
-      if (ignore_secondaries) { stack_manager -> clear();                                   secondaries_no  += 1; }
-      else { /* do nothing, and everything from waiting is automatically moved to urgent */ secondaries_yes += 1; }
+      if (ignore_secondaries) { stack_manager -> clear();                                   job_metrics::bump(metrics.secondaries_no ); }
+      else { /* do nothing, and everything from waiting is automatically moved to urgent */ job_metrics::bump(metrics.secondaries_yes); event_cost.row.stage_2 = 1; }
     }
   };
 
@@ -645,20 +951,59 @@ int main(int argc, char** argv) {
   run_manager = unique_ptr<G4RunManager> {G4RunManagerFactory::CreateRunManager(G4RunManagerType::Serial)};
 
   // ----- Geometry (run_manager takes ownership) -----------------------------------------
-  run_manager -> SetUserInitialization(new n4::geometry{[&write_sensor_database, geometry]() -> G4VPhysicalVolume* {
-    return write_sensor_database(geometry());
+  run_manager -> SetUserInitialization(new n4::geometry{[&]() -> G4VPhysicalVolume* {
+    auto world = cached_geometry();
+    // Everything from here on must also suit a world loaded from the geometry cache
+    catalogue  = make_unique<n4::geometry_catalogue>(world);
+    scint_volumes = scintillator_volumes(world, scint_name);
+    { auto& d = messenger.detector; // Those built from Hamamatsu tiles: see detector()
+      auto tiled = d == "imas" || d == "cylinder" ||
+                   (messenger.magic_level < 3 && (d == "square" || d == "hamamatsu"));
+      if (messenger.geometry != "phantom" && tiled) { write_sensor_database(*catalogue); }
+    }
+    set_production_cuts(world);
+    if (! messenger.light_map.empty()) {
+      if (light_model) { light_model -> set_scintillator(scint_volumes); } // Geometry rebuilt
+      else {
+        light_map_in_use = make_unique<light_map>(light_map::load(messenger.light_map));
+        light_model      = make_unique<lxe_light_model>(scint_volumes, *light_map_in_use, record_photon);
+      }
+    }
+    // Tables are only built at the start of the first run: too late to key them by material
+    if (! messenger.physics_table_cache.empty()) {
+      remove_stale_physics_tables(messenger.physics_table_cache);
+      physics_table_dir = physics_table_directory(messenger.physics_table_cache, physics_table_key(physics_list));
+      if (physics_tables_stored(physics_table_dir)) {
+        physics_list -> SetPhysicsTableRetrieved(physics_table_dir);
+        std::cout << "Physics tables retrieved from cache: " << physics_table_dir << std::endl;
+      }
+    }
+    return world;
   }});
   // ----- Physics list --------------------------------------------------------------------
-  { auto verbosity = 0;     n4::use_our_optical_physics(run_manager.get(), verbosity); }
+  { auto verbosity = 0;
+    auto& p = messenger.physics;
+    physics_list =
+      p == "FTFP_BERT"           ? n4::use_our_optical_physics(run_manager.get(), verbosity)        :
+      p == "lean_pet"            ? n4::use_lean_pet_physics   (run_manager.get(), verbosity)        :
+      p == "lean_pet_no_optical" ? n4::use_lean_pet_physics   (run_manager.get(), verbosity, false) :
+      (FATAL(("Unrecoginzed physics list: " + p).c_str()), nullptr);
+    if (! messenger.light_map.empty()) {
+      auto fast_simulation = new G4FastSimulationPhysics{};
+      fast_simulation -> ActivateFastSimulation("e-");
+      physics_list    -> RegisterPhysics(fast_simulation);
+    }
+  }
   // ----- User actions (only generator is mandatory) --------------------------------------
-  auto actions = (new n4::actions{generator_messenger.generator()})
+  auto actions = (new n4::actions{generate_primaries})
     -> set ((new n4::run_action)      -> begin(start_run)
                                       -> end  (  end_run))
-    -> set ((new n4::event_action)    -> begin(begin_event))
+    -> set ((new n4::event_action)    -> begin(begin_event)
+                                      -> end  (  end_event))
     -> set ((new n4::stacking_action) -> classify  (   kill_or_wait_secondaries)
                                       -> next_stage(forget_or_track_secondaries)
                                       -> next_event(reset_stage_no))
-    -> set  (new n4::stepping_action{stepping_action});
+    -> set  (plain_stepping_action = new n4::stepping_action_t{stepping_action});
 
   run_manager -> SetUserInitialization(actions);
   // ----- Construct density map if requested ------------------------------------------
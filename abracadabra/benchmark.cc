@@ -0,0 +1,217 @@
+// clang-format off
+// End-to-end performance benchmark: runs abracadabra over a fixed matrix of
+// phantoms, detectors and magic levels, each cell with fixed seeds and event
+// count, and reports events/s, steps/s, peak RSS, output bytes per event and
+// initialization time.
+//
+// Cells use FTFP_BERT physics, except for those whose names end in the name of
+// another physics list: compare them with the FTFP_BERT cell of the same
+// phantom, detector and magic level (e.g. for init time and peak RSS).
+//
+//   abracadabra-benchmark [--report FILE] [--baseline FILE] [--tolerance FRACTION]
+//                         [--only SUBSTRING] [--events-scale X] [--executable PATH]
+//
+// Each cell runs in its own abracadabra process (Geant4 cannot be
+// reinitialized within one), in `benchmark-work/`. With --baseline, exits with
+// status 1 if any metric of any cell is worse than the baseline's by more than
+// the tolerance (default 0.1).
+
+#include "io/benchmark_report.hh"
+#include "io/job_metrics.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+extern char** environ;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct cell {
+  std::string phantom, detector, scintillator;
+  unsigned    magic_level;
+  unsigned    events;
+  std::string physics = "FTFP_BERT";
+
+  std::string name() const {
+    auto d = scintillator.empty() ? detector : detector + "_" + scintillator;
+    auto p = physics == "FTFP_BERT" ? "" : "/" + physics;
+    return phantom + "/" + d + "/magic_" + std::to_string(magic_level) + p;
+  }
+};
+
+// Fewer events where more is simulated per event: each cell takes seconds to
+// minutes, not hours
+const unsigned events_at_magic_level[] = {10, 200, 1000, 1000};
+
+std::vector<cell> benchmark_matrix(double events_scale) {
+  struct detector { std::string name, scintillator; };
+  std::vector<cell> cells;
+  for (std::string phantom : {"sanity", "nema_3", "nema_4", "nema_7", "jaszczak"}) {
+    for (detector d : {detector{"imas", ""}, {"scintillator", "LXe"}, {"scintillator", "LYSO"}}) {
+      for (unsigned magic=0; magic<4; ++magic) {
+        // The scintillator detector raises magic level 0 to 1: same as the next cell
+        if (d.name == "scintillator" && magic == 0) { continue; }
+        auto events = std::max(1u, static_cast<unsigned>(events_at_magic_level[magic] * events_scale));
+        cells.push_back({phantom, d.name, d.scintillator, magic, events});
+      }
+    }
+  }
+  // The physics lists compared on one phantom and detector only: the
+  // difference lies mostly in initialization, which the geometry hardly affects
+  for (unsigned magic=0; magic<4; ++magic) {
+    auto events = std::max(1u, static_cast<unsigned>(events_at_magic_level[magic] * events_scale));
+    cells.push_back({"nema_7", "imas", "", magic, events, "lean_pet"});
+  }
+  return cells;
+}
+
+// The detector dimensions of production jobs (mm), as in macs/model.mac: the
+// messenger's defaults describe a much smaller detector
+struct detector_dimensions { double cylinder_length, cylinder_radius; };
+const detector_dimensions production{1000, 350};
+
+// Fixed seeds and settings, so that every run of a cell simulates the same events
+void write_macros(cell const& c, fs::path const& dir) {
+  std::ofstream model{dir / "model.mac"};
+  model << "/abracadabra/geometry both\n"
+        << "/abracadabra/physics "     << c.physics     << '\n'
+        << "/abracadabra/phantom "     << c.phantom     << '\n'
+        << "/abracadabra/detector "    << c.detector    << '\n'
+        << "/abracadabra/cylinder_length " << production.cylinder_length << '\n'
+        << "/abracadabra/cylinder_radius " << production.cylinder_radius << '\n';
+  if (! c.scintillator.empty()) {
+    model << "/abracadabra/scintillator " << c.scintillator << '\n';
+  }
+  model << "/abracadabra/magic_level " << c.magic_level << '\n'
+        << "/abracadabra/metrics_file " << (dir / "metrics").string() << '\n';
+
+  std::ofstream run{dir / "run.mac"};
+  run << "/abracadabra/outfile " << (dir / "MC.h5").string() << '\n'
+      << "/random/setSeeds 123456 987654\n"
+      << "/run/initialize\n"
+      << "/control/verbose 0\n"
+      << "/run/verbose 0\n"
+      << "/event/verbose 0\n"
+      << "/tracking/verbose 0\n"
+      << "/abracadabra/verbosity 0\n"
+      << "/run/beamOn " << c.events << '\n';
+}
+
+// Runs abracadabra with its output in `log`; returns its peak RSS in MB, if it succeeded
+std::optional<double> run_job(std::string const& executable, fs::path const& dir) {
+  auto model = (dir / "model.mac").string(), run = (dir / "run.mac").string(), log = (dir / "log").string();
+  char* argv[] = {const_cast<char*>(executable.c_str()), model.data(), run.data(), nullptr};
+
+  posix_spawn_file_actions_t files;
+  posix_spawn_file_actions_init(&files);
+  posix_spawn_file_actions_addopen(&files, STDOUT_FILENO, log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  posix_spawn_file_actions_adddup2(&files, STDOUT_FILENO, STDERR_FILENO);
+
+  pid_t pid;
+  auto failed = posix_spawn(&pid, executable.c_str(), &files, nullptr, argv, environ);
+  posix_spawn_file_actions_destroy(&files);
+  if (failed) { return std::nullopt; }
+
+  int status;
+  rusage usage;
+  wait4(pid, &status, 0, &usage);
+  if (! WIFEXITED(status) || WEXITSTATUS(status) != 0) { return std::nullopt; }
+  return usage.ru_maxrss / 1024.0; // ru_maxrss is in kB
+}
+
+std::optional<benchmark_result> run_cell(cell const& c, std::string const& executable) {
+  auto dir = fs::path{"benchmark-work"} / c.name();
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  write_macros(c, dir);
+
+  auto peak_rss_mb = run_job(executable, dir);
+  if (! peak_rss_mb) {
+    std::cerr << "FAILED: " << c.name() << ", see " << (dir / "log").string() << std::endl;
+    return std::nullopt;
+  }
+  auto stats = metrics_publisher::read((dir / "metrics").string());
+  if (! (stats.run_seconds > 0)) {
+    std::cerr << "FAILED: " << c.name() << ", no run time in " << (dir / "metrics").string() << std::endl;
+    return std::nullopt;
+  }
+  auto events = std::max<uint64_t>(stats.events, 1);
+  return benchmark_result{c.name(),
+                          stats.events / stats.run_seconds,
+                          stats.steps  / stats.run_seconds,
+                          *peak_rss_mb,
+                          static_cast<double>(fs::file_size(dir / "MC.h5")) / events,
+                          stats.init_seconds};
+}
+
+[[noreturn]] void usage() {
+  std::cerr << "Usage: abracadabra-benchmark [--report FILE] [--baseline FILE] [--tolerance FRACTION]\n"
+            << "                             [--only SUBSTRING] [--events-scale X] [--executable PATH]\n";
+  std::exit(2);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::string report_file = "benchmark-report.tsv", baseline_file, only, executable = "./abracadabra";
+  double tolerance = 0.1, events_scale = 1;
+  for (int i=1; i<argc; ++i) {
+    std::string arg = argv[i];
+    if (i + 1 == argc) { usage(); }
+    std::string value = argv[++i];
+    if      (arg == "--report"      ) { report_file   = value; }
+    else if (arg == "--baseline"    ) { baseline_file = value; }
+    else if (arg == "--tolerance"   ) { tolerance     = std::stod(value); }
+    else if (arg == "--only"        ) { only          = value; }
+    else if (arg == "--events-scale") { events_scale  = std::stod(value); }
+    else if (arg == "--executable"  ) { executable    = value; }
+    else                              { usage(); }
+  }
+
+  std::vector<benchmark_result> results;
+  bool all_succeeded = true;
+  std::cout << std::setw(40) << std::left << "cell" << std::right
+            << std::setw(12) << "events/s" << std::setw(12) << "steps/s" << std::setw(10) << "RSS MB"
+            << std::setw(12) << "bytes/event" << std::setw(10) << "init s" << std::endl;
+  for (auto& c : benchmark_matrix(events_scale)) {
+    if (c.name().find(only) == std::string::npos) { continue; }
+    auto result = run_cell(c, executable);
+    if (! result) { all_succeeded = false; continue; }
+    auto& r = *result;
+    std::cout << std::setw(40) << std::left << r.cell << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << r.events_per_second << std::setw(12) << std::setprecision(0) << r.steps_per_second
+              << std::setw(10) << r.peak_rss_mb << std::setw(12) << r.bytes_per_event
+              << std::setw(10) << std::setprecision(1) << r.init_seconds << std::endl;
+    results.push_back(r);
+  }
+
+  std::ofstream report{report_file};
+  write_benchmark_report(report, results);
+  std::cout << "Report written to " << report_file << std::endl;
+
+  if (baseline_file.empty()) { return all_succeeded ? 0 : 1; }
+  std::ifstream baseline_stream{baseline_file};
+  if (! baseline_stream) { std::cerr << "Cannot read baseline " << baseline_file << std::endl; return 2; }
+  auto regressions = compare_benchmarks(results, read_benchmark_report(baseline_stream), tolerance);
+  for (auto& r : regressions) {
+    std::cout << "REGRESSION " << r.cell << ' ' << r.metric << ": "
+              << std::setprecision(2) << r.baseline << " -> " << r.current << std::endl;
+  }
+  std::cout << regressions.size() << " regressions beyond " << 100 * tolerance << " % of "
+            << baseline_file << std::endl;
+  return regressions.empty() && all_succeeded ? 0 : 1;
+}
@@ -25,4 +25,22 @@ void generator::geantino_along_x(G4Event* event) {
   event->AddPrimaryVertex(vertex);
 }
 
+// ----- event arena -----------------------------------------------------------------
+event_arena::event_arena(size_t initial_bytes)
+  : size{initial_bytes}
+  , buffer{new std::byte[initial_bytes]}
+{
+  arena.emplace(buffer.get(), size, &overflow);
+}
+
+void event_arena::reset() {
+  arena.reset(); // Returns any overflow to the heap
+  if (overflow.bytes) {
+    size += overflow.bytes;
+    buffer.reset(new std::byte[size]);
+    overflow.bytes = 0;
+  }
+  arena.emplace(buffer.get(), size, &overflow);
+}
+
 } // namespace nain4
@@ -5,6 +5,8 @@
 #include <G4ClassificationOfNewTrack.hh>
 #include <G4ParticleGun.hh>
 #include <G4StackManager.hh>
+#include <G4Step.hh>
+#include <G4ThreeVector.hh>
 #include <G4Track.hh>
 #include <G4UserEventAction.hh>
 #include <G4UserRunAction.hh>
@@ -18,6 +20,11 @@
 
 #include <globals.hh>
 
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <utility>
 #include <vector>
 
 namespace nain4 {
@@ -102,6 +109,24 @@ private:
   action_t action;
 };
 
+// Same, but storing the callable itself rather than a std::function, so that
+// it can be inlined into UserSteppingAction: the only indirection left per
+// step is Geant4's virtual call. Use as `new n4::stepping_action_t{lambda}`.
+template<class F>
+struct stepping_action_t : public G4UserSteppingAction {
+  stepping_action_t(F action) : action{std::move(action)} {}
+  void UserSteppingAction(const G4Step* step) override { action(step); }
+private:
+  F action;
+};
+
+// Several step handlers combined into one, at compile time: each is called
+// in turn, in the order given
+template<class... Fs>
+auto compose_steps(Fs... handlers) {
+  return [=](const G4Step* step) mutable { (handlers(step), ...); };
+}
+
 // ----- primary generator ----------------------------------------------------------
 struct generator : public G4VUserPrimaryGeneratorAction {
   using function = std::function<void(G4Event*)>;
@@ -147,17 +172,63 @@ private:
 };
 
 // --------------------------------------------------------------------------------
-// TODO Currently has a hard-wired storing of steps: generalize :
+// Memory for containers which live no longer than one event. Allocation is a
+// pointer bump, deallocation does nothing, and reset() (at the start of each
+// event) gives everything back at once. The buffer grows to fit the largest
+// event seen so far, after which events allocate nothing from the heap.
+class event_arena {
+public:
+  explicit event_arena(size_t initial_bytes = 1 << 20);
+  std::pmr::memory_resource* resource() { return &*arena; }
+  // Nothing allocated from resource() may still be alive
+  void reset();
+  size_t capacity() const { return size; }
+
+private:
+  // Where the arena goes when the buffer is full: counts how much it needed
+  struct overflow_t : std::pmr::memory_resource {
+    size_t bytes = 0;
+    void* do_allocate(size_t n, size_t alignment) override {
+      bytes += n;
+      return std::pmr::new_delete_resource() -> allocate(n, alignment);
+    }
+    void do_deallocate(void* p, size_t n, size_t alignment) override {
+      std::pmr::new_delete_resource() -> deallocate(p, n, alignment);
+    }
+    bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override { return this == &other; }
+  };
+
+  size_t                                             size;
+  std::unique_ptr<std::byte[]>                       buffer;
+  overflow_t                                         overflow;
+  std::optional<std::pmr::monotonic_buffer_resource> arena;
+};
+
+// --------------------------------------------------------------------------------
+// What is worth keeping about a photon arriving at a sensor: much smaller than
+// the G4Step in which it arrived.
+struct sensor_hit {
+  G4int         sensor_id;
+  G4double      time;
+  G4ThreeVector position;
+  G4double      wavelength;
+};
+
 // The subclass via which G4 insists that you manage the information that
-// interests you about an event.
+// interests you about an event. Full copies of the steps are only kept when
+// debugging, on request. The containers keep the allocator they are given: if
+// that is an event_arena, the G4Event must not be kept beyond its event.
 struct event_data : public G4VUserEventInformation {
-  event_data(std::vector<G4Step>&& hits) : G4VUserEventInformation(), hits{std::move(hits)} {}
+  event_data(std::pmr::vector<sensor_hit>&& hits, std::pmr::vector<G4Step>&& steps = {})
+    : G4VUserEventInformation(), hits{std::move(hits)}, steps{std::move(steps)} {}
   ~event_data() override {};
   void Print() const override {/* purely virtual in superclass */};
-  void set_hits(std::vector<G4Step>&& sensor_hits) { hits = std::move(sensor_hits); }
-  std::vector<G4Step>& get_hits() { return hits; }
+  void set_hits(std::pmr::vector<sensor_hit>&& sensor_hits) { hits = std::move(sensor_hits); }
+  std::pmr::vector<sensor_hit>& get_hits () { return hits; }
+  std::pmr::vector<G4Step>    & get_steps() { return steps; }
 private:
-  std::vector<G4Step> hits;
+  std::pmr::vector<sensor_hit> hits;
+  std::pmr::vector<G4Step>     steps;
 };
 
 } // namespace nain4
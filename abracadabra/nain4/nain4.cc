@@ -1,14 +1,22 @@
 #include "nain4.hh"
 
 #include <G4EmStandardPhysics_option4.hh>
+#include <G4OpticalPhoton.hh>
 #include <G4OpticalPhysics.hh>
 #include <G4Box.hh>
 #include <FTFP_BERT.hh>
 #include <G4PVPlacement.hh>
+#include <G4ReplicaNavigation.hh>
+#include <G4VPVParameterisation.hh>
+#include <G4ProductionCuts.hh>
+#include <G4ProductionCutsTable.hh>
 #include <G4String.hh>
+#include <G4SystemOfUnits.hh>
 
 #include <algorithm>
+#include <iomanip>
 #include <iterator>
+#include <ostream>
 
 namespace nain4 {
 
@@ -106,15 +114,46 @@ silence::~silence() { stream.rdbuf(original_buffer); }
 
 
 // Set optical physics lists
-void use_our_optical_physics(G4RunManager* run_manager, G4int verbosity) {
+G4VModularPhysicsList* use_our_optical_physics(G4RunManager* run_manager, G4int verbosity) {
     auto physics_list = new FTFP_BERT{verbosity};
     physics_list -> ReplacePhysics(new G4EmStandardPhysics_option4());
     physics_list -> RegisterPhysics(new G4OpticalPhysics{});
     run_manager  -> SetUserInitialization(physics_list);
+    return physics_list;
+} // run_manager owns physics_list
+
+G4VModularPhysicsList* use_lean_pet_physics(G4RunManager* run_manager, G4int verbosity, bool optical) {
+    auto physics_list = new G4VModularPhysicsList{};
+    physics_list -> SetVerboseLevel(verbosity);
+    physics_list -> SetDefaultCutValue(0.7 * CLHEP::mm); // As in FTFP_BERT
+    physics_list -> RegisterPhysics(new G4EmStandardPhysics_option4{verbosity});
+    if (optical) { physics_list -> RegisterPhysics(new G4OpticalPhysics{verbosity}); }
+    else         { G4OpticalPhoton::Definition(); } // Still looked up by user code
+    run_manager  -> SetUserInitialization(physics_list);
+    return physics_list;
 } // run_manager owns physics_list
 
 
 
+G4Region* region::now() {
+  auto the_region = find_region(name, false);
+  if (! the_region) { the_region = new G4Region{name}; } // G4RegionStore owns it
+  for (auto root : roots) { the_region -> AddRootLogicalVolume(root); }
+
+  if (all_cut || ! cuts.empty()) {
+    auto production_cuts = the_region -> GetProductionCuts();
+    auto world_cuts = G4ProductionCutsTable::GetProductionCutsTable() -> GetDefaultProductionCuts();
+    // Never modify the defaults: other regions share them
+    if (! production_cuts || production_cuts == world_cuts) {
+      production_cuts = world_cuts ? new G4ProductionCuts{*world_cuts} : new G4ProductionCuts;
+      the_region -> SetProductionCuts(production_cuts);
+    }
+    if (all_cut) { production_cuts -> SetProductionCut(all_cut.value()); }
+    for (auto [particle, length] : cuts) { production_cuts -> SetProductionCut(length, particle); }
+  }
+  return the_region;
+}
+
 G4VPhysicalVolume* combine_geometries(G4VPhysicalVolume* phantom, G4VPhysicalVolume* detector) {
   auto detector_envelope = detector -> GetLogicalVolume();
   auto phantom_envelope  =  phantom -> GetLogicalVolume();
@@ -144,10 +183,122 @@ G4VPhysicalVolume* combine_geometries(G4VPhysicalVolume* phantom, G4VPhysicalVol
   }
 
   n4::place(phantom_logical).in(detector_envelope).at(phantom_translation).now();
+  // So that the phantom may be given its own production cuts
+  n4::region("Phantom").add(phantom_logical).now();
   return detector;
 };
 
 
+} // namespace nain4
+
+namespace nain4 {
+
+const std::vector<size_t> geometry_catalogue::nothing{};
+
+geometry_catalogue::geometry_catalogue(G4VPhysicalVolume* world) {
+  auto local = [](G4VPhysicalVolume* v) { return G4Transform3D{v->GetObjectRotationValue(), v->GetObjectTranslation()}; };
+  add(world, none, local(world), world->GetCopyNo());
+
+  G4ReplicaNavigation replica_navigation;
+  // Entries appended while looping are visited in turn: breadth-first
+  for (size_t mother=0; mother<entries_.size(); ++mother) {
+    auto logical = entries_[mother].logical;
+    auto global  = entries_[mother].global; // Copy: appending invalidates references
+    for (size_t d=0; d<logical->GetNoDaughters(); ++d) {
+      auto daughter = logical->GetDaughter(d);
+      if (! daughter->IsReplicated()) {
+        add(daughter, mother, global * local(daughter), daughter->GetCopyNo());
+        continue;
+      }
+      // Move the daughter to each copy in turn, as the navigator does
+      auto parameterisation = daughter->GetParameterisation();
+      for (G4int copy=0; copy<daughter->GetMultiplicity(); ++copy) {
+        if (parameterisation) { parameterisation->ComputeTransformation(copy, daughter); }
+        else                  { replica_navigation.ComputeTransformation(copy, daughter); }
+        add(daughter, mother, global * local(daughter), copy);
+      }
+    }
+  }
+}
+
+void geometry_catalogue::add(G4VPhysicalVolume* volume, size_t parent, G4Transform3D const& global, G4int copy_no) {
+  auto [it, is_new] = name_ids.try_emplace(volume->GetName(), names.size());
+  if (is_new) { names.push_back(volume->GetName()); with_name.emplace_back(); }
+  auto index   = entries_.size();
+  auto logical = volume->GetLogicalVolume();
+  entries_.push_back({volume, logical, parent, global, copy_no, it->second});
+  with_name[it->second].push_back(index);
+  with_logical[logical].push_back(index);
+  with_copy.try_emplace({logical, copy_no}, index);
+}
+
+std::vector<size_t> const& geometry_catalogue::named(G4String const& name) const {
+  auto found = name_ids.find(name);
+  return found == name_ids.end() ? nothing : with_name[found->second];
+}
+
+std::vector<size_t> const& geometry_catalogue::placements_of(G4LogicalVolume* logical) const {
+  auto found = with_logical.find(logical);
+  return found == with_logical.end() ? nothing : found->second;
+}
+
+std::optional<size_t> geometry_catalogue::find(G4LogicalVolume* logical, G4int copy_no) const {
+  auto found = with_copy.find({logical, copy_no});
+  if (found == with_copy.end()) { return std::nullopt; }
+  return found->second;
+}
+
+void step_profiler::clear() {
+  counts.clear();
+  countdown   = 0;
+  timing      = 0;
+  timed_track = nullptr;
+  timed_step  = 0;
+  start_ticks = ticks();
+  start_time  = std::chrono::steady_clock::now();
+}
+
+std::vector<step_profiler::entry> step_profiler::summary() const {
+  // Calibrate the tick rate over the whole profiling period
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+  auto elapsed_ticks = ticks() - start_ticks;
+  auto seconds_per_tick = elapsed_ticks ? elapsed.count() / elapsed_ticks : 0;
+
+  std::vector<entry> result;
+  for (auto& [k, c] : counts) {
+    auto [volume, process, particle] = k;
+    result.push_back({volume   ? volume   -> GetName()         : "None",
+                      process  ? process  -> GetProcessName()  : "None",
+                      particle ? particle -> GetParticleName() : "None",
+                      c.steps, c.timeable, c.sampled, c.ticks * seconds_per_tick});
+  }
+  std::sort(begin(result), end(result), [](auto& a, auto& b) {
+    return a.seconds() != b.seconds() ? a.seconds() > b.seconds() : a.steps > b.steps;
+  });
+  return result;
+}
+
+void step_profiler::print(std::ostream& out, size_t max_rows) const {
+  auto rows = summary();
+  uint64_t total_steps = 0; G4double total_seconds = 0;
+  for (auto& row : rows) { total_steps += row.steps; total_seconds += row.seconds(); }
+
+  using std::setw;
+  out << "Step profile (1 in " << sample_every << " steps timed): "
+      << total_steps << " steps, " << std::fixed << std::setprecision(2) << total_seconds << " s estimated\n"
+      << setw(20) << "volume" << setw(20) << "process" << setw(16) << "particle"
+      << setw(14) << "steps" << setw(10) << "s" << setw(8) << "%" << setw(10) << "us/step" << '\n';
+  for (size_t i=0; i<rows.size() && i<max_rows; ++i) {
+    auto& r = rows[i];
+    out << setw(20) << r.volume << setw(20) << r.process << setw(16) << r.particle
+        << setw(14) << r.steps
+        << setw(10) << std::setprecision(2) << r.seconds()
+        << setw(8)  << std::setprecision(1) << (total_seconds ? 100 * r.seconds() / total_seconds : 0)
+        << setw(10) << std::setprecision(3) << (r.timeable ? 1e6 * r.seconds() / r.timeable : 0) << '\n';
+  }
+  if (rows.size() > max_rows) { out << "   ... and " << rows.size() - max_rows << " more\n"; }
+}
+
 } // namespace nain4
 
 geometry_iterator begin(G4VPhysicalVolume& vol) { return geometry_iterator{&vol}; }
@@ -12,6 +12,8 @@
 #include <G4ParticleDefinition.hh>
 #include <G4ParticleTable.hh>
 #include <G4PhysicalVolumeStore.hh>
+#include <G4Region.hh>
+#include <G4RegionStore.hh>
 #include <G4RotationMatrix.hh>
 #include <G4Run.hh>
 #include <G4RunManager.hh>
@@ -25,7 +27,9 @@
 #include <G4VUserActionInitialization.hh>
 #include <G4VUserDetectorConstruction.hh>
 #include <G4VisAttributes.hh>
+#include <G4VModularPhysicsList.hh>
 
+#include <map>
 #include <string>
 #include <utility>
 #include <vector>
@@ -78,6 +82,7 @@ IA element       NAME     { return G4NistManager        ::   Instance()->FindOrB
 IA find_logical  NAME_VRB { return G4LogicalVolumeStore ::GetInstance()->GetVolume          (name, verbose); }
 IA find_physical NAME_VRB { return G4PhysicalVolumeStore::GetInstance()->GetVolume          (name, verbose); }
 IA find_solid    NAME_VRB { return G4SolidStore         ::GetInstance()->GetSolid           (name, verbose); }
+IA find_region   NAME_VRB { return G4RegionStore        ::GetInstance()->GetRegion          (name, verbose); }
 IA find_particle NAME     { return G4ParticleTable:: GetParticleTable()->FindParticle       (name         ); }
 
 IA event_number  ()       { return G4RunManager::GetRunManager()->GetCurrentRun()->GetNumberOfEvent(); }
@@ -180,6 +185,29 @@ private:
   G4Transform3D               transformation = HepGeom::Transform3D::Identity;
 };
 
+// --------------------------------------------------------------------------------
+// Find or create a region, adding root logical volumes and production cuts to
+// it. Particles whose cuts are not specified get those of the world region
+// (the physics list's defaults) as they are when `now()` is first called with
+// any cuts.
+class region {
+public:
+  region(G4String name) : name(name) {}
+
+  region& add(G4LogicalVolume* root)                    { roots.push_back(root)   ; return *this; }
+  region& cut(G4double length)                          { all_cut = length        ; return *this; }
+  region& cut(G4String particle, G4double length)       { cuts[particle] = length ; return *this; }
+
+  G4Region* operator()()                                { return now(); }
+  G4Region* now();
+
+private:
+  G4String                          name;
+  std::vector<G4LogicalVolume*>     roots;
+  optional<G4double>                all_cut;
+  std::map<G4String, G4double>      cuts;
+};
+
 // --------------------------------------------------------------------------------
 // Utility for creating a vector of physical quantity data, without having to
 // repeat the physical unit in each element.
@@ -253,8 +281,14 @@ private:
 };
 
 // --------------------------------------------------------------------------------
-// Use our flavour of optical physics: jump through 3 hoops in one go
-void use_our_optical_physics(G4RunManager* run_manager, G4int verbosity=0);
+// Use our flavour of optical physics: jump through 3 hoops in one go.
+// The physics list is returned, so that more physics may be registered before
+// initialization (run_manager owns it).
+G4VModularPhysicsList* use_our_optical_physics(G4RunManager* run_manager, G4int verbosity=0);
+
+// Leaner alternative for PET at 511 keV: EM option4 (optionally with optical
+// physics) and nothing hadronic, so far fewer particles and tables to build.
+G4VModularPhysicsList* use_lean_pet_physics(G4RunManager* run_manager, G4int verbosity=0, bool optical=true);
 
 // --------------------------------------------------------------------------------
 // Not really nain4, as it's kinda specific to PET / NEMA?
@@ -292,6 +326,7 @@ public:
     if (!this->q.empty()) {
       auto current = this->q.front();
       this->q.pop();
+      this->visited++;
       queue_daughters(*current->GetLogicalVolume());
     }
     return *this;
@@ -300,11 +335,17 @@ public:
   pointer   operator->()       { return this->q.front(); }
   reference operator* () const { return this->q.front(); }
 
-  friend bool operator== (const geometry_iterator& a, const geometry_iterator& b) { return a.q == b.q; };
-  friend bool operator!= (const geometry_iterator& a, const geometry_iterator& b) { return a.q != b.q; };
+  // O(1): all exhausted iterators are equal; otherwise iterators over the same
+  // geometry are equal when they have visited as many volumes
+  friend bool operator== (const geometry_iterator& a, const geometry_iterator& b) {
+    if (a.q.empty() || b.q.empty()) { return a.q.empty() && b.q.empty(); }
+    return a.visited == b.visited && a.q.front() == b.q.front();
+  };
+  friend bool operator!= (const geometry_iterator& a, const geometry_iterator& b) { return !(a == b); };
 
 private:
   std::queue<G4VPhysicalVolume*> q{};
+  size_t visited = 0;
 
   void queue_daughters(G4LogicalVolume const& logical) {
     for(size_t d=0; d<logical.GetNoDaughters(); ++d) {
@@ -325,6 +366,236 @@ geometry_iterator   end(G4LogicalVolume&);
 geometry_iterator begin(G4LogicalVolume*);
 geometry_iterator   end(G4LogicalVolume*);
 
+// --------------------------------------------------------------------------------
+// Flattened catalogue of a complete geometry, built once, for indexed lookups
+// instead of repeated scans with geometry_iterator. There is one entry per
+// placement of every volume, in breadth-first order. Replicated and
+// parameterised volumes are expanded into one entry per copy.
+
+#include <G4Transform3D.hh>
+
+#include <limits>
+#include <unordered_map>
+
+namespace nain4 {
+
+class geometry_catalogue {
+public:
+  static constexpr size_t none = std::numeric_limits<size_t>::max();
+
+  struct entry {
+    G4VPhysicalVolume* volume;
+    G4LogicalVolume*   logical;
+    size_t             parent;  // Index of the mother's entry; `none` for the world
+    G4Transform3D      global;  // From this copy's frame to the world's
+    G4int              copy_no;
+    size_t             name_id; // Interned name of `volume`: see `name`
+
+    G4ThreeVector position() const { return global.getTranslation(); }
+  };
 
+  explicit geometry_catalogue(G4VPhysicalVolume* world);
+
+  size_t                    size      (            ) const { return entries_.size(); }
+  entry const&              operator[](size_t index) const { return entries_[index]; }
+  std::vector<entry> const& entries   (            ) const { return entries_; }
+  G4String const&           name      (size_t id   ) const { return names[id]; }
+
+  // Indices of all entries with this (physical volume) name, or logical volume
+  std::vector<size_t> const& named        (G4String const&  ) const;
+  std::vector<size_t> const& placements_of(G4LogicalVolume* ) const;
+  // First entry of this logical volume with this copy number
+  std::optional<size_t>      find         (G4LogicalVolume*, G4int copy_no) const;
+
+private:
+  void add(G4VPhysicalVolume*, size_t parent, G4Transform3D const& global, G4int copy_no);
+
+  struct copy_hash {
+    size_t operator()(std::pair<G4LogicalVolume*, G4int> const& k) const {
+      return std::hash<G4LogicalVolume*>{}(k.first) ^ (std::hash<G4int>{}(k.second) * 0x9e3779b97f4a7c15ull);
+    }
+  };
+
+  std::vector<entry>                                    entries_;
+  std::vector<G4String>                                 names;
+  std::unordered_map<std::string, size_t>               name_ids;
+  std::vector<std::vector<size_t>>                      with_name; // Indexed by name id
+  std::unordered_map<G4LogicalVolume*, std::vector<size_t>> with_logical;
+  std::unordered_map<std::pair<G4LogicalVolume*, G4int>, size_t, copy_hash> with_copy;
+  static const std::vector<size_t>                      nothing;
+};
+
+// --------------------------------------------------------------------------------
+// Where does the time go? Opt-in instrumentation of stepping: counts every step
+// per (logical volume, process, particle), and times every `sample_every`th
+// step with the CPU's timestamp counter. A step is timed from the end of the
+// user's stepping actions for the previous step of the same track, to the start
+// of those for this step, so the time is Geant4's alone. The first step of a
+// track has no such interval: only later steps are `timeable`, and the
+// estimated time covers those.
+//
+// Costs nothing unless it wraps the stepping action, e.g.
+//
+//   new n4::stepping_action_t{profiler.around(n4::compose_steps(one_action, other_action))}
+
+#include <G4Step.hh>
+#include <G4VProcess.hh>
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace nain4 {
+
+class step_profiler {
+public:
+  struct entry {
+    G4String volume, process, particle;
+    uint64_t steps;
+    uint64_t timeable;        // Steps which are not the first of their track
+    uint64_t sampled;         // Timeable steps which were timed
+    G4double sampled_seconds; // Total time of the sampled steps
+    G4double seconds() const { return sampled ? sampled_seconds * timeable / sampled : 0; } // Estimated
+  };
+
+  explicit step_profiler(unsigned sample_every = 100) : sample_every{sample_every} { clear(); }
+
+  // Call before the user's stepping actions for `step` ...
+  void stop(G4Step const* step) {
+    auto stopped = ticks();
+    auto& c = counts[key_of(step)];
+    c.steps++;
+    auto track = step -> GetTrack();
+    if (track -> GetCurrentStepNumber() > 1) { c.timeable++; }
+    if (timing) {
+      // Only a step of the same track measures a step: anything else means
+      // the interval also covers the end of a track, or of an event
+      if (track == timed_track && track -> GetCurrentStepNumber() == timed_step + 1) {
+        c.sampled++;
+        c.ticks += stopped - timing;
+      }
+      timing = 0;
+    }
+  }
+
+  // ... and after them
+  void start(G4Step const* step) {
+    if (++countdown == sample_every) {
+      auto track  = step -> GetTrack();
+      countdown   = 0;
+      timed_track = track;
+      timed_step  = track -> GetCurrentStepNumber();
+      timing      = ticks();
+    }
+  }
+
+  template<class F>
+  auto around(F action) {
+    return [this, action](G4Step const* step) { stop(step); action(step); start(step); };
+  }
+  auto handler() { return around([](G4Step const*) {}); }
+
+  // Most expensive first
+  std::vector<entry> summary() const;
+  void print(std::ostream&, size_t max_rows = 20) const;
+  void clear();
+
+private:
+  using key = std::tuple<G4LogicalVolume const*, G4VProcess const*, G4ParticleDefinition const*>;
+  struct key_hash {
+    size_t operator()(key const& k) const {
+      auto [v, p, d] = k;
+      return std::hash<void const*>{}(v) ^ (std::hash<void const*>{}(p) * 0x9e3779b97f4a7c15ull)
+                                         ^ (std::hash<void const*>{}(d) * 0xc2b2ae3d27d4eb4full);
+    }
+  };
+  struct count { uint64_t steps = 0, timeable = 0, sampled = 0, ticks = 0; };
+
+  static key key_of(G4Step const* step) {
+    auto pre     = step -> GetPreStepPoint();
+    auto volume  = pre  -> GetPhysicalVolume();
+    return {volume ? volume -> GetLogicalVolume() : nullptr,
+            step -> GetPostStepPoint() -> GetProcessDefinedStep(),
+            step -> GetTrack() -> GetParticleDefinition()};
+  }
+
+  static uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+  }
+
+  unsigned sample_every;
+  unsigned countdown;
+  uint64_t timing; // Start of the step being timed, 0 if none
+  G4Track const* timed_track; // Whose next step is being timed
+  G4int          timed_step;
+  std::unordered_map<key, count, key_hash> counts;
+  // For converting ticks to seconds
+  uint64_t                              start_ticks;
+  std::chrono::steady_clock::time_point start_time;
+};
+
+} // namespace nain4
+
+// --------------------------------------------------------------------------------
+// NB: I can't help feeling that we're reinventing a wheel that HDF5 should
+// already be implementing for us, but I haven't managed to find it in the
+// documentation:
+
+// Some of our HDF5 tables need to store strings whose values repeat many times.
+// For example, we expect only 3 different processes at our LXe vertices (Rayl,
+// compt, phot), but they will be stored *many* times. Similarly, the name of
+// the volume in which a step terminates, can take on a limited number of
+// values, but will be recorded in each vertex. Rather storing a copy each time,
+// it's much more memory-efficient to store each name once, along with a unique
+// identifier int, and store that int instead of the string itself. For this we
+// need a utility which can tell us the id of any such string, creating new ids
+// on the fly, for values we haven't seen before, and retrieving the already
+// assigned ids of values that we have seen before.
+//
+// The names of Geant4 objects (volumes, processes) can be looked up by object
+// instead: each name is then found once per object, and later lookups only
+// hash the pointer. Objects may be deleted between runs, so call
+// `forget_objects` at the start of each run.
+
+#include <initializer_list>
+#include <string_view>
+
+namespace nain4 {
+
+class id_store {
+public:
+  id_store(std::initializer_list<std::string_view> names = {}) { for (auto name : names) { id(name); } }
+
+  size_t id(std::string_view name) {
+    auto [found, is_new] = ids.try_emplace(std::string{name}, items.size());
+    if (is_new) { items.emplace_back(name); }
+    return found->second;
+  }
+
+  // `name` is that of `object`, used only the first time `object` is seen
+  size_t id(void const* object, std::string_view name) {
+    auto found = object_ids.find(object);
+    if (found != object_ids.end()) { return found->second; }
+    return object_ids[object] = id(name);
+  }
+  void forget_objects() { object_ids.clear(); }
+
+  std::vector<std::string> const& items_ordered_by_id() const { return items; }
+
+private:
+  std::unordered_map<std::string, size_t> ids;
+  std::vector<std::string>                items;
+  std::unordered_map<void const*, size_t> object_ids;
+};
+
+} // namespace nain4
 
 #endif
@@ -0,0 +1,78 @@
+// clang-format off
+
+#include "fastsim/light_map.hh"
+#include "io/hdf5.hh"
+
+#include <G4SystemOfUnits.hh>
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+TEST_CASE("light map voxels", "[light_map]") {
+  light_map map{{4, 36, 10, 200*mm, 230*mm, 500*mm}};
+  CHECK(map.n_voxels() == 4 * 36 * 10);
+
+  // Points outside the scintillator belong to no voxel
+  CHECK(! map.voxel({199*mm,   0   , 0}));
+  CHECK(! map.voxel({230*mm,   0   , 0}));
+  CHECK(! map.voxel({210*mm,   0   , 500*mm}));
+  CHECK(! map.voxel({210*mm,   0   ,-501*mm}));
+
+  // Random points generated in a voxel fall within that voxel
+  for (size_t voxel=0; voxel<map.n_voxels(); voxel += 7) {
+    for (auto i=0; i<10; ++i) {
+      auto found = map.voxel(map.random_point_in(voxel));
+      REQUIRE(found);
+      CHECK(*found == voxel);
+    }
+  }
+}
+
+TEST_CASE("light map generation and loading", "[light_map][hdf5]") {
+  light_map::binning bins{2, 4, 3, 200*mm, 230*mm, 100*mm};
+  std::string prefix = std::tmpnam(nullptr);
+
+  // Two jobs contributing to the same map, with different numbers of photons
+  // emitted from, and detected in, the same voxels
+  auto generate = [&](auto file_name, auto n_emitted, auto times) {
+    light_map map{bins};
+    map.emitted(5, n_emitted);
+    for (auto t : times) { map.detected(5, 42, t); }
+    map.detected(5, 43, 10*ns);
+    map.emitted(7, n_emitted); // Nothing detected
+    hdf5_io writer{file_name};
+    map.write(writer);
+  };
+  generate(prefix + "-0.h5", 100, std::vector{1*ns, 2*ns, 3*ns});
+  generate(prefix + "-1.h5", 300, std::vector{4*ns, 5*ns});
+
+  auto map = light_map::load(prefix + "-*.h5");
+  CHECK(map.n_voxels() == 2 * 4 * 3);
+  CHECK(map.bins().r_max == 230*mm);
+
+  auto& responses = map.responses(5);
+  REQUIRE(responses.size() == 2);
+  CHECK(responses[0].sensor_id   == 42);
+  CHECK(responses[0].probability == Approx(5.0 / 400));
+  CHECK(responses[0].mean_time   == Approx(3*ns));
+  CHECK(responses[0].sigma_time  == Approx(std::sqrt(2.0)*ns));
+  CHECK(responses[1].sensor_id   == 43);
+  CHECK(responses[1].probability == Approx(2.0 / 400));
+  CHECK(responses[1].sigma_time  == Approx(0).margin(1e-9));
+  CHECK(map.efficiency(5) == Approx(7.0 / 400));
+
+  CHECK(map.responses (7).empty());
+  CHECK(map.efficiency(7) == 0);
+  CHECK(map.efficiency(0) == 0); // Never generated
+
+  // Sensors are chosen in proportion to their detection probabilities
+  auto N = 10000, n_42 = 0;
+  for (auto i=0; i<N; ++i) { if (map.random_response(5).sensor_id == 42) { n_42++; } }
+  CHECK(static_cast<double>(n_42) / N == Approx(5.0 / 7).margin(0.02));
+
+  std::remove((prefix + "-0.h5").c_str());
+  std::remove((prefix + "-1.h5").c_str());
+}
@@ -0,0 +1,125 @@
+#include "fastsim/light_map.hh"
+
+#include "nain4.hh"
+
+#include <G4PhysicalConstants.hh>
+
+#include <glob.h>
+
+#include <cmath>
+
+light_map::light_map(binning bins)
+  : the_bins{bins}
+  , n_emitted  (bins.n_r * bins.n_phi * bins.n_z, 0)
+  , accumulated(n_emitted.size())
+{}
+
+std::optional<size_t> light_map::voxel(G4ThreeVector const& p) const {
+  auto& b = the_bins;
+  auto r   = p.perp();
+  auto phi = p.phi(); if (phi < 0) { phi += CLHEP::twopi; }
+  auto z   = p.z();
+  if (r < b.r_min || r >= b.r_max || std::abs(z) >= b.half_z) { return std::nullopt; }
+  auto index = [](auto x, auto lo, auto hi, auto n) {
+    return std::min(static_cast<size_t>((x - lo) / (hi - lo) * n), static_cast<size_t>(n - 1));
+  };
+  auto i_r   = index(r  ,  b.r_min   , b.r_max     , b.n_r  );
+  auto i_phi = index(phi,  0.0       , CLHEP::twopi, b.n_phi);
+  auto i_z   = index(z  , -b.half_z  , b.half_z    , b.n_z  );
+  return (i_r * b.n_phi + i_phi) * b.n_z + i_z;
+}
+
+G4ThreeVector light_map::random_point_in(size_t voxel) const {
+  auto& b = the_bins;
+  auto i_z   =  voxel % b.n_z;
+  auto i_phi = (voxel / b.n_z) % b.n_phi;
+  auto i_r   =  voxel / b.n_z  / b.n_phi;
+  auto dr   = (b.r_max - b.r_min) / b.n_r;
+  auto dphi = CLHEP::twopi        / b.n_phi;
+  auto dz   = 2 * b.half_z        / b.n_z;
+  auto r_lo = b.r_min + i_r * dr;
+  auto r_hi = r_lo + dr;
+  // Uniform in area, rather than in r
+  auto r   = std::sqrt(uniform(r_lo * r_lo, r_hi * r_hi));
+  auto phi = uniform(i_phi * dphi, (i_phi + 1) * dphi);
+  auto z   = uniform(-b.half_z + i_z * dz, -b.half_z + (i_z + 1) * dz);
+  return {r * std::cos(phi), r * std::sin(phi), z};
+}
+
+void light_map::emitted(size_t voxel, size_t n_photons) { n_emitted[voxel] += n_photons; }
+
+void light_map::detected(size_t voxel, unsigned sensor_id, G4double time) {
+  add(voxel, sensor_id, {1, time, time * time});
+}
+
+void light_map::add(size_t voxel, unsigned sensor_id, accumulator const& more) {
+  auto& acc = accumulated[voxel][sensor_id];
+  acc.n      += more.n;
+  acc.sum_t  += more.sum_t;
+  acc.sum_t2 += more.sum_t2;
+}
+
+void light_map::write(hdf5_io& writer) const {
+  std::vector<light_map_voxel_t   > voxels;
+  std::vector<light_map_response_t> responses;
+  for (size_t v=0; v<n_voxels(); ++v) {
+    if (n_emitted[v] == 0) { continue; }
+    voxels.push_back({static_cast<u32>(v), n_emitted[v]});
+    for (auto& [sensor_id, acc] : accumulated[v]) {
+      responses.push_back({static_cast<u32>(v), sensor_id, acc.n, acc.sum_t, acc.sum_t2});
+    }
+  }
+  writer.write_light_map(the_bins, voxels, responses);
+}
+
+light_map light_map::load(std::string const& glob_pattern) {
+  glob_t found;
+  if (glob(glob_pattern.c_str(), 0, nullptr, &found) != 0) {
+    globfree(&found);
+    FATAL(("No light map files match " + glob_pattern).c_str());
+  }
+  std::vector<std::string> file_names{found.gl_pathv, found.gl_pathv + found.gl_pathc};
+  globfree(&found);
+
+  std::optional<light_map> map;
+  for (auto& file_name : file_names) {
+    auto [bins, voxels, responses] = hdf5_io::read_light_map(file_name);
+    if (! map) { map.emplace(bins); }
+    auto& b = map -> the_bins;
+    if (bins.n_r   != b.n_r   || bins.n_phi != b.n_phi  || bins.n_z    != b.n_z  ||
+        bins.r_min != b.r_min || bins.r_max != b.r_max  || bins.half_z != b.half_z) {
+      FATAL(("Light map " + file_name + " has a different binning from " + file_names[0]).c_str());
+    }
+    for (auto& v : voxels   ) { map -> emitted(v.voxel, v.n_emitted); }
+    for (auto& r : responses) { map -> add(r.voxel, r.sensor_id, {r.n_detected, r.sum_t, r.sum_t2}); }
+  }
+  map -> finalize();
+  G4cout << "Loaded light map from " << file_names.size() << " file(s) matching " << glob_pattern << G4endl;
+  return std::move(*map);
+}
+
+void light_map::finalize() {
+  the_responses    .assign(n_voxels(), {});
+  total_probability.assign(n_voxels(), 0);
+  choose_response  .assign(n_voxels(), std::nullopt);
+  for (size_t v=0; v<n_voxels(); ++v) {
+    if (n_emitted[v] == 0) { continue; }
+    std::vector<G4double> weights;
+    for (auto& [sensor_id, acc] : accumulated[v]) {
+      auto n     = static_cast<G4double>(acc.n);
+      auto mean  = acc.sum_t / n;
+      auto sigma = std::sqrt(std::max(0.0, acc.sum_t2 / n - mean * mean));
+      auto p     = n / n_emitted[v];
+      the_responses[v].push_back({sensor_id, p, mean, sigma});
+      total_probability[v] += p;
+      weights.push_back(p);
+    }
+    if (! weights.empty()) { choose_response[v].emplace(std::move(weights)); }
+  }
+  // Only the finalized responses are needed from now on
+  accumulated.assign(n_voxels(), {});
+}
+
+light_map::response const& light_map::random_response(size_t voxel) const {
+  return the_responses[voxel][(*choose_response[voxel])()];
+}
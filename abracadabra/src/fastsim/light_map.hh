@@ -0,0 +1,73 @@
+#ifndef fastsim_light_map_hh
+#define fastsim_light_map_hh
+
+#include "io/hdf5.hh"
+#include "random/random.hh"
+
+#include <G4ThreeVector.hh>
+#include <G4Types.hh>
+
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Precomputed optical response of the scintillator.
+//
+// The scintillator (a cylindrical shell) is divided into voxels in r, phi and
+// z. For each voxel, the light map records how many of the optical photons
+// emitted there (isotropically, at t=0) were detected by each sensor, and the
+// distribution of their arrival times.
+//
+// Light maps are *generated* with full optical simulation, by emitting photons
+// from random points in each voxel (`emitted` and `detected`), and written to
+// HDF5. Generation can be spread across many jobs, each of which writes its
+// own file: `load` sums the contents of all the files matching a glob pattern.
+//
+// Once loaded, the map is *used* to sample detected photons directly from an
+// energy deposit, without tracking any optical photons (see lxe_light_model).
+class light_map {
+public:
+  using binning = light_map_binning_t;
+
+  struct response {
+    unsigned sensor_id;
+    G4double probability; // of detecting one emitted photon
+    G4double mean_time, sigma_time;
+  };
+
+  light_map(binning);
+  static light_map load(std::string const& glob_pattern);
+
+  size_t                  n_voxels() const { return n_emitted.size(); }
+  std::optional<size_t>   voxel(G4ThreeVector const&) const;
+  G4ThreeVector random_point_in(size_t voxel) const;
+  binning const& bins() const { return the_bins; }
+
+  // ----- Generation
+  void emitted (size_t voxel, size_t n_photons);
+  void detected(size_t voxel, unsigned sensor_id, G4double time);
+  void write(hdf5_io&) const;
+
+  // ----- Use
+  // Expected number of photons detected per photon emitted in this voxel
+  G4double                     efficiency(size_t voxel) const { return total_probability[voxel]; }
+  std::vector<response> const& responses (size_t voxel) const { return the_responses[voxel]; }
+  // Which of this voxel's responses detected a photon: only meaningful if
+  // efficiency(voxel) > 0
+  response const& random_response(size_t voxel) const;
+
+private:
+  struct accumulator { u64 n = 0; G4double sum_t = 0, sum_t2 = 0; };
+  void add(size_t voxel, unsigned sensor_id, accumulator const&);
+  void finalize();
+
+  binning the_bins;
+  std::vector<u64>                                n_emitted;
+  std::vector<std::map<unsigned, accumulator>>    accumulated;
+  std::vector<std::vector<response>>              the_responses;
+  std::vector<G4double>                           total_probability;
+  std::vector<std::optional<biased_choice>>       choose_response;
+};
+
+#endif // fastsim_light_map_hh
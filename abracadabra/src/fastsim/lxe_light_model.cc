@@ -0,0 +1,93 @@
+#include "fastsim/lxe_light_model.hh"
+
+#include "nain4.hh"
+
+#include <G4Electron.hh>
+#include <G4FastStep.hh>
+#include <G4FastTrack.hh>
+#include <G4Poisson.hh>
+#include <G4Region.hh>
+#include <G4SystemOfUnits.hh>
+#include <Randomize.hh>
+
+#include <algorithm>
+
+namespace {
+G4Region* region_of(std::vector<G4LogicalVolume*> const& scintillator) {
+  if (scintillator.empty()) { FATAL("Light map model needs a scintillator"); }
+  return n4::region("Scintillator").add(scintillator.front()).now(); // Shared with its production cuts
+}
+
+G4double const_property(G4LogicalVolume* volume, const char* name) {
+  auto properties = volume -> GetMaterial() -> GetMaterialPropertiesTable();
+  if (! properties || ! properties -> ConstPropertyExists(name)) {
+    FATAL(("Light map model needs " + std::string{name} + " in " + volume -> GetName()).c_str());
+  }
+  return properties -> GetConstProperty(name);
+}
+}
+
+lxe_light_model::lxe_light_model(volumes const& scintillator, light_map const& map, photon_sink detected)
+  : G4VFastSimulationModel{"LXe_light_map", region_of(scintillator)}
+  , map             {map}
+  , detected        {detected}
+{
+  set_scintillator(scintillator);
+}
+
+void lxe_light_model::set_scintillator(volumes const& scintillator) {
+  region_of(scintillator);
+  this -> scintillator = scintillator;
+  auto layer = scintillator.front();
+  yield            = const_property(layer, "SCINTILLATIONYIELD");
+  resolution_scale = const_property(layer, "RESOLUTIONSCALE");
+  fast_fraction    = const_property(layer, "YIELDRATIO");
+  fast_time        = const_property(layer, "FASTTIMECONSTANT");
+  slow_time        = const_property(layer, "SLOWTIMECONSTANT");
+}
+
+G4bool lxe_light_model::IsApplicable(G4ParticleDefinition const& particle) {
+  return &particle == G4Electron::Definition();
+}
+
+// The region also contains the scintillator's daughters: only trigger inside
+// the volumes which are part of the scintillator
+G4bool lxe_light_model::ModelTrigger(G4FastTrack const& fast_track) {
+  auto volume = fast_track.GetPrimaryTrack() -> GetVolume();
+  if (! volume) { return false; }
+  auto logical = volume -> GetLogicalVolume();
+  return std::find(scintillator.begin(), scintillator.end(), logical) != scintillator.end();
+}
+
+void lxe_light_model::DoIt(G4FastTrack const& fast_track, G4FastStep& fast_step) {
+  auto track  = fast_track.GetPrimaryTrack();
+  auto energy = track -> GetKineticEnergy();
+  auto t0     = track -> GetGlobalTime();
+
+  fast_step.KillPrimaryTrack();
+  fast_step.ProposePrimaryTrackPathLength(0);
+  fast_step.ProposeTotalEnergyDeposited(energy);
+
+  auto voxel = map.voxel(track -> GetPosition());
+  if (! voxel || map.efficiency(*voxel) <= 0) { return; }
+
+  // Number of scintillation photons, as in G4Scintillation
+  auto mean = yield * energy;
+  G4long n_emitted = mean > 10
+    ? std::max(0L, std::lround(G4RandGauss::shoot(mean, resolution_scale * std::sqrt(mean))))
+    : G4Poisson(mean);
+
+  // Detection probability per photon is small: thinning the Poisson-ish
+  // emission by it is well approximated by a Poisson
+  auto n_detected = G4Poisson(n_emitted * map.efficiency(*voxel));
+  for (G4long n=0; n<n_detected; ++n) {
+    auto& response = map.random_response(*voxel);
+    auto propagation = std::max(0.0, G4RandGauss::shoot(response.mean_time, response.sigma_time));
+    detected(response.sensor_id, t0 + scintillation_delay() + propagation);
+  }
+}
+
+G4double lxe_light_model::scintillation_delay() const {
+  auto tau = biased_coin(fast_fraction) ? fast_time : slow_time;
+  return CLHEP::RandExponential::shoot(tau);
+}
@@ -0,0 +1,49 @@
+#ifndef fastsim_lxe_light_model_hh
+#define fastsim_lxe_light_model_hh
+
+#include "fastsim/light_map.hh"
+
+#include <G4VFastSimulationModel.hh>
+
+#include <functional>
+#include <vector>
+
+// Replaces the scintillation of electrons in the scintillator, and the tracking
+// of the resulting optical photons, with sampling from a precomputed light map.
+//
+// Each electron entering (or created in) the scintillator deposits all its
+// energy on the spot. The number of scintillation photons follows the
+// material's SCINTILLATIONYIELD and RESOLUTIONSCALE, exactly as in
+// G4Scintillation; the detected ones are distributed among the sensors with
+// the probabilities recorded in the light map for the voxel containing the
+// deposit. Each detected photon's arrival time is the deposit time, plus the
+// scintillation delay (fast/slow components of the material), plus the
+// propagation delay sampled from the map.
+class lxe_light_model : public G4VFastSimulationModel {
+public:
+  using photon_sink = std::function<void(unsigned sensor_id, G4double time)>;
+
+  // `scintillator`: all the volumes that are part of it, the layer itself
+  // first (see scintillator_volumes in geometries/imas.hh). `map` must outlive
+  // the model. Geant4 keeps the model registered with the scintillator's
+  // region until the end of the job: create one per job, and tell it about the
+  // scintillator of any rebuilt geometry.
+  using volumes = std::vector<G4LogicalVolume*>;
+  lxe_light_model(volumes const& scintillator, light_map const& map, photon_sink detected);
+  void set_scintillator(volumes const& scintillator);
+
+  G4bool IsApplicable(G4ParticleDefinition const&) override;
+  G4bool ModelTrigger(G4FastTrack const&)          override;
+  void   DoIt        (G4FastTrack const&, G4FastStep&) override;
+
+private:
+  G4double scintillation_delay() const;
+
+  volumes          scintillator;
+  light_map const& map;
+  photon_sink      detected;
+  G4double yield, resolution_scale;
+  G4double fast_fraction, fast_time, slow_time;
+};
+
+#endif // fastsim_lxe_light_model_hh
@@ -0,0 +1,47 @@
+// clang-format off
+
+#include "geometries/acceptance.hh"
+
+#include <G4RandomDirection.hh>
+#include <G4SystemOfUnits.hh>
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+
+TEST_CASE("back to back acceptance", "[acceptance]") {
+  auto radius = 350*mm, half_z = 500*mm;
+
+  SECTION("at the centre: analytic") {
+    auto expected = half_z / std::sqrt(half_z * half_z + radius * radius);
+    CHECK(back_to_back_acceptance({}, radius, half_z) == Approx(expected));
+    CHECK(  back_to_back_accepted({}, {1, 0, 0}, radius, half_z));
+    CHECK(! back_to_back_accepted({}, {0, 0, 1}, radius, half_z));
+  }
+
+  SECTION("off centre: agrees with Monte Carlo") {
+    for (auto vertex : {G4ThreeVector{100*mm,  50*mm, 300*mm},
+                        G4ThreeVector{  0   , 200*mm,-450*mm},
+                        G4ThreeVector{-30*mm,   0   ,   0   }}) {
+      auto N = 100000, accepted = 0;
+      for (auto i=0; i<N; ++i) {
+        if (back_to_back_accepted(vertex, G4RandomDirection(), radius, half_z)) { accepted++; }
+      }
+      CHECK(back_to_back_acceptance(vertex, radius, half_z) == Approx(static_cast<double>(accepted) / N).margin(0.005));
+    }
+  }
+
+  SECTION("outside the bore: no filtering") {
+    CHECK(back_to_back_acceptance({0, 0, 600*mm}, radius, half_z) == 1);
+    CHECK(back_to_back_accepted  ({0, 0, 600*mm}, {0, 0, 1}, radius, half_z));
+  }
+
+  SECTION("resampled directions are accepted") {
+    G4ThreeVector vertex{10*mm, 20*mm, 400*mm};
+    for (auto i=0; i<1000; ++i) {
+      auto direction = random_accepted_direction(vertex, radius, half_z);
+      CHECK(direction.mag() == Approx(1));
+      CHECK(back_to_back_accepted(vertex, direction, radius, half_z));
+    }
+  }
+}
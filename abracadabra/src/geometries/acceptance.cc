@@ -0,0 +1,64 @@
+#include "geometries/acceptance.hh"
+
+#include <G4PhysicalConstants.hh>
+#include <G4RandomDirection.hh>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+bool outside_bore(G4ThreeVector const& vertex, G4double radius, G4double half_z) {
+  return vertex.perp() >= radius || std::abs(vertex.z()) >= half_z;
+}
+
+// Does the ray from `p` along `d` cross the cylinder within |z| <= half_z?
+// `p` is inside the cylinder.
+bool ray_hits(G4ThreeVector const& p, G4ThreeVector const& d, G4double radius, G4double half_z) {
+  auto a = d.x() * d.x() + d.y() * d.y();
+  if (a == 0) { return false; }
+  auto b = p.x() * d.x() + p.y() * d.y();
+  auto c = p.perp2() - radius * radius;
+  auto t = (-b + std::sqrt(b * b - a * c)) / a;
+  return std::abs(p.z() + t * d.z()) <= half_z;
+}
+}
+
+bool back_to_back_accepted(G4ThreeVector const& vertex, G4ThreeVector const& direction,
+                           G4double radius, G4double half_z) {
+  if (outside_bore(vertex, radius, half_z)) { return true; }
+  return ray_hits(vertex,  direction, radius, half_z) &&
+         ray_hits(vertex, -direction, radius, half_z);
+}
+
+// For fixed phi, the two rays travel transverse distances s_fwd and s_bwd to
+// the cylinder, reaching z = z0 + s_fwd * cot(theta) and z = z0 - s_bwd * cot(theta).
+// Requiring both to lie in [-half_z, half_z] gives an interval of cot(theta),
+// which maps onto an interval of cos(theta): uniformly distributed for
+// isotropic directions.
+G4double back_to_back_acceptance(G4ThreeVector const& vertex,
+                                 G4double radius, G4double half_z, unsigned n_phi) {
+  if (outside_bore(vertex, radius, half_z)) { return 1; }
+  auto x = vertex.x(), y = vertex.y(), z = vertex.z();
+  auto c = x*x + y*y - radius * radius;
+  auto cos_of_cot = [](auto cot) { return cot / std::sqrt(1 + cot * cot); };
+
+  G4double total = 0;
+  for (unsigned n=0; n<n_phi; ++n) {
+    auto phi  = (n + 0.5) * CLHEP::twopi / n_phi;
+    auto b    = x * std::cos(phi) + y * std::sin(phi);
+    auto root = std::sqrt(b * b - c);
+    auto s_fwd = root - b, s_bwd = root + b;
+    auto cot_lo = std::max((-half_z - z) / s_fwd, (z - half_z) / s_bwd);
+    auto cot_hi = std::min(( half_z - z) / s_fwd, (z + half_z) / s_bwd);
+    if (cot_hi > cot_lo) { total += (cos_of_cot(cot_hi) - cos_of_cot(cot_lo)) / 2; }
+  }
+  return total / n_phi;
+}
+
+G4ThreeVector random_accepted_direction(G4ThreeVector const& vertex,
+                                        G4double radius, G4double half_z) {
+  G4ThreeVector direction;
+  do { direction = G4RandomDirection(); }
+  while (! back_to_back_accepted(vertex, direction, radius, half_z));
+  return direction;
+}
@@ -0,0 +1,28 @@
+#ifndef geometries_acceptance_hh
+#define geometries_acceptance_hh
+
+#include <G4ThreeVector.hh>
+#include <G4Types.hh>
+
+// Geometric acceptance of back-to-back gamma pairs: both lines must cross the
+// inner surface of the scintillator, a cylinder of `radius` spanning
+// |z| <= half_z, in opposite directions from the vertex.
+//
+// Scattering on the way to the scintillator is ignored. Vertices outside the
+// bore (r >= radius or |z| >= half_z) are always accepted: their gammas might
+// enter the scintillator through its ends.
+
+bool back_to_back_accepted(G4ThreeVector const& vertex, G4ThreeVector const& direction,
+                           G4double radius, G4double half_z);
+
+// Fraction of isotropic directions that are accepted: integrated analytically
+// over theta and by midpoint quadrature in phi.
+G4double back_to_back_acceptance(G4ThreeVector const& vertex,
+                                 G4double radius, G4double half_z, unsigned n_phi = 360);
+
+// Isotropic direction, resampled until accepted. Must only be used when the
+// acceptance is not zero.
+G4ThreeVector random_accepted_direction(G4ThreeVector const& vertex,
+                                        G4double radius, G4double half_z);
+
+#endif // geometries_acceptance_hh
@@ -7,6 +7,8 @@
 #include <G4SystemOfUnits.hh>
 #include <G4Tubs.hh>
 
+#include <vector>
+
 using nain4::material;
 using nain4::place;
 using nain4::volume;
@@ -18,7 +20,8 @@ G4PVPlacement* compare_scintillators(
     G4String sci_name,
     G4double length,
     G4double scintillator_inner_radius,
-    G4double dr_scintillator
+    G4double dr_scintillator,
+    bool     flat_layers
 ) {
   auto air     = material("G4_AIR");
   auto steel   = material("G4_STAINLESS-STEEL");
@@ -38,14 +41,18 @@ G4PVPlacement* compare_scintillators(
   G4double cavity_radius = scintillator_inner_radius - (dr_steel_0 + dr_vacuum + dr_steel_1);
 
   // ----- Utility for wrapping smaller cylinder inside a larger one --------------
+  // or, with flat_layers, for adding an annular shell around it (see imas.cc)
   G4LogicalVolume*   log_out = nullptr; // Current outermost logical volume
   G4VPhysicalVolume* phy_prv = nullptr; // Physical volume directly inside log_out
+  std::vector<G4LogicalVolume*> shells;
   auto radius = 0.0;
-  auto layer = [=, &radius, &log_out, &phy_prv](auto& name, auto material, auto dr) {
+  auto layer = [=, &radius, &log_out, &phy_prv, &shells](auto& name, auto material, auto dr) {
       if (dr == 0) return;
+      auto r_min = (flat_layers && log_out) ? radius : 0.0;
       radius += dr;
-      auto log_new = volume<G4Tubs>(name, material, 0.0, radius, length/2, 0.0, twopi);
-      if (log_out) { phy_prv = place(log_out).in(log_new).now(); }
+      auto log_new = volume<G4Tubs>(name, material, r_min, radius, length/2, 0.0, twopi);
+      if (flat_layers)  { shells.push_back(log_new); }
+      else if (log_out) { phy_prv = place(log_out).in(log_new).now(); }
       log_out = log_new;
   };
 
@@ -60,7 +67,8 @@ G4PVPlacement* compare_scintillators(
   auto env_width  = 1.1 * radius;
 
   auto vol_envelope = volume<G4Box>("Envelope", air, env_width, env_width, env_length);
-  place(log_out).in(vol_envelope).now();
+  if (flat_layers) { for (auto shell : shells) { place(shell).in(vol_envelope).now(); } }
+  else             {                             place(log_out).in(vol_envelope).now();  }
   return place(vol_envelope).now();
 
 }
@@ -10,7 +10,8 @@ G4PVPlacement* compare_scintillators(
     G4String scintillator,
     G4double length,
     G4double scintillator_inner_radius,
-    G4double dr_scintillator
+    G4double dr_scintillator,
+    bool     flat_layers = false
 );
 
 #endif // geometries_compare_scintillators_hh
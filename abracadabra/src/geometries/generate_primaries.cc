@@ -4,12 +4,34 @@
 
 #include <G4SystemOfUnits.hh>
 #include <G4RandomDirection.hh>
+#include <G4OpticalPhoton.hh>
+#include <Randomize.hh>
 
 void generate_back_to_back_511_keV_gammas(G4Event* event, G4ThreeVector position, G4double time) {
+  generate_back_to_back_511_keV_gammas(event, position, time, G4RandomDirection());
+}
+
+void generate_back_to_back_511_keV_gammas(G4Event* event, G4ThreeVector position, G4double time,
+                                          G4ThreeVector direction) {
   auto gamma = nain4::find_particle("gamma");
-  auto p = 511*keV * G4RandomDirection();
+  auto p = 511*keV * direction.unit();
   auto vertex =      new G4PrimaryVertex(position, time);
   vertex->SetPrimary(new G4PrimaryParticle(gamma,  p.x(),  p.y(),  p.z()));
   vertex->SetPrimary(new G4PrimaryParticle(gamma, -p.x(), -p.y(), -p.z()));
   event -> AddPrimaryVertex(vertex);
 }
+
+void generate_optical_photons(G4Event* event, G4ThreeVector position, G4double time,
+                              size_t n_photons, G4double (*energy)()) {
+  auto photon = G4OpticalPhoton::Definition();
+  auto vertex = new G4PrimaryVertex(position, time);
+  for (size_t n=0; n<n_photons; ++n) {
+    auto direction    = G4RandomDirection();
+    auto polarization = direction.orthogonal().unit().rotate(CLHEP::twopi * G4UniformRand(), direction);
+    auto p = energy() * direction;
+    auto particle = new G4PrimaryParticle(photon, p.x(), p.y(), p.z());
+    particle -> SetPolarization(polarization);
+    vertex   -> SetPrimary(particle);
+  }
+  event -> AddPrimaryVertex(vertex);
+}
@@ -5,6 +5,12 @@
 
 // TODO this needs to live elsewhere
 void generate_back_to_back_511_keV_gammas(G4Event* event, G4ThreeVector position, G4double time);
+void generate_back_to_back_511_keV_gammas(G4Event* event, G4ThreeVector position, G4double time,
+                                          G4ThreeVector direction);
+
+// Isotropic, randomly polarized optical photons, with energies drawn from `energy`
+void generate_optical_photons(G4Event* event, G4ThreeVector position, G4double time,
+                              size_t n_photons, G4double (*energy)());
 
 template<class PHANTOM>
 void generate_primaries(PHANTOM const& phantom, G4Event* event) {
@@ -2,12 +2,23 @@
 
 #include "geometries/imas.hh"
 
+#include <G4GeometryManager.hh>
+#include <G4Navigator.hh>
+#include <G4ProductionCuts.hh>
+#include <G4ProductionCutsTable.hh>
+#include <G4Region.hh>
+#include <G4RegionStore.hh>
+#include <G4TouchableHistory.hh>
+#include <G4Tubs.hh>
 #include <G4VSolid.hh>
 #include <G4SystemOfUnits.hh>
 #include <G4UnitsTable.hh>
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <map>
+#include <memory>
 #include <tuple>
 
 TEST_CASE("IMAS demonstrator geometry", "[imas][geometry]") {
@@ -59,3 +70,186 @@ TEST_CASE("IMAS demonstrator geometry", "[imas][geometry]") {
   // }
 
 }
+
+TEST_CASE("IMAS replicated SiPM ring", "[imas][geometry][replica]") {
+  auto find_tiles = [](auto& world) {
+    std::vector<G4VPhysicalVolume*> tiles;
+    for (auto volume: world) {
+      if (volume -> GetName().rfind("Hamamatsu_Blue", 0) == 0) { tiles.push_back(volume); }
+    }
+    return tiles;
+  };
+
+  auto& placed     = *imas_demonstrator(nullptr, 70*cm, 0, 20*mm, false, false);
+  auto& replicated = *imas_demonstrator(nullptr, 70*cm, 0, 20*mm, false, true );
+
+  // Far fewer volumes: envelope, 7 layers, ring, sector, column and 2 active regions
+  CHECK(std::distance(begin(replicated), end(replicated)) == 13);
+
+  auto placed_tiles = find_tiles(placed);
+  auto column_tiles = find_tiles(replicated);
+  REQUIRE(column_tiles.size() == 1);
+  auto column = dynamic_cast<sipm_column*>(column_tiles[0] -> GetParameterisation());
+  REQUIRE(column);
+
+  // Same sensors in the same positions
+  auto positions = column -> sensor_positions();
+  REQUIRE(positions.size() == placed_tiles.size());
+  std::map<unsigned, G4ThreeVector> placed_positions;
+  for (auto tile : placed_tiles) { placed_positions[tile -> GetCopyNo()] = tile -> GetTranslation(); }
+  for (auto [id, p] : positions) {
+    REQUIRE(placed_positions.count(id) == 1);
+    CHECK((p - placed_positions[id]).mag() == Approx(0).margin(1e-9*mm));
+  }
+
+  // The navigator finds the same sensor in both geometries, at the centre of
+  // each tile's sensitive region
+  auto locate = [](auto& world, auto point) {
+    G4Navigator navigator;
+    navigator.SetWorldVolume(&world);
+    navigator.LocateGlobalPointAndSetup(point);
+    return std::unique_ptr<G4TouchableHistory>{navigator.CreateTouchableHistory()};
+  };
+  auto geometry_manager = G4GeometryManager::GetInstance();
+  geometry_manager -> CloseGeometry(true, false, &replicated);
+  for (size_t n=0; n<placed_tiles.size(); n += 97) {
+    auto tile    = placed_tiles[n];
+    auto active  = tile -> GetLogicalVolume() -> GetDaughter(0);
+    REQUIRE(active -> GetName() == "fake_active");
+    auto point   = G4Transform3D{tile -> GetObjectRotationValue(), tile -> GetObjectTranslation()}
+                 * HepGeom::Point3D<G4double>{active -> GetTranslation()};
+    auto touchable = locate(replicated, G4ThreeVector{point});
+    REQUIRE(touchable -> GetVolume() -> GetName() == "fake_active");
+    CHECK(sipm_sensor_id(touchable.get()) == static_cast<unsigned>(tile -> GetCopyNo()));
+  }
+  geometry_manager -> OpenGeometry(&replicated);
+}
+
+TEST_CASE("IMAS replicated SiPM ring is scintillator", "[imas][geometry][replica]") {
+  // No quartz: the 0.6 mm thick tiles sit in the outermost mm of the LXe
+  auto& world = *imas_demonstrator(nullptr, 70*cm, 0, 20*mm, false, true);
+  auto lxe_outer_r = (325 + 1.5 + 25 + 1.5 + 20) * mm;
+  auto scintillator = scintillator_volumes(&world, "LXe");
+  auto is_scintillator = [&](G4LogicalVolume* logical) {
+    return std::find(begin(scintillator), end(scintillator), logical) != end(scintillator);
+  };
+
+  // The ring and its sectors keep names of their own, but are part of the scintillator
+  std::map<G4String, size_t> found;
+  for (auto logical : scintillator) { found[logical -> GetName()]++; }
+  CHECK(found == std::map<G4String, size_t>{{"LXe", 1}, {"SiPM_ring", 1}, {"SiPM_sector", 1}});
+
+  auto geometry_manager = G4GeometryManager::GetInstance();
+  geometry_manager -> CloseGeometry(true, false, &world);
+  G4Navigator navigator;
+  navigator.SetWorldVolume(&world);
+
+  // Where a gamma step ends, between the tiles: the stepping action and the
+  // light map model must see the scintillator
+  size_t in_ring = 0;
+  for (auto n=0; n<2000; ++n) {
+    auto r   = lxe_outer_r - 0.9*mm + 0.6*mm * (n % 7 + 0.5) / 7; // Tile depth
+    auto phi = 0.0037 * n, z = (n % 101 - 50) * 5*mm;
+    auto volume  = navigator.LocateGlobalPointAndSetup({r * std::cos(phi), r * std::sin(phi), z});
+    auto logical = volume -> GetLogicalVolume();
+    if (logical -> GetMaterial() != scintillator.front() -> GetMaterial()) { continue; } // In a tile
+    CHECK(is_scintillator(logical));
+    if (volume -> GetName() == "SiPM_sector") { ++in_ring; }
+  }
+  CHECK(in_ring > 100);
+  geometry_manager -> OpenGeometry(&world);
+}
+
+TEST_CASE("IMAS sensors in geometry catalogue", "[imas][geometry][catalogue]") {
+  // Same ids and positions, whether tiles are placed individually or replicated
+  auto sensors = [](bool replicated) {
+    auto world = imas_demonstrator(nullptr, 70*cm, 0, 20*mm, false, replicated);
+    n4::geometry_catalogue catalogue{world};
+    std::map<unsigned, G4ThreeVector> found;
+    auto& entries = catalogue.entries();
+    auto tile = std::find_if(begin(entries), end(entries), [](auto& e) { return e.logical -> GetName() == "Hamamatsu_Blue"; });
+    REQUIRE(tile != end(entries));
+    for (auto index : catalogue.placements_of(tile -> logical)) {
+      found[sipm_sensor_id(catalogue, index)] = catalogue[index].position();
+    }
+    return found;
+  };
+  auto placed     = sensors(false);
+  auto replicated = sensors(true);
+  REQUIRE(placed.size() == replicated.size());
+  REQUIRE(placed.size() > 1000);
+  for (auto [id, p] : placed) {
+    REQUIRE(replicated.count(id) == 1);
+    CHECK((replicated[id] - p).mag() == Approx(0).margin(1e-9*mm));
+  }
+}
+
+TEST_CASE("IMAS flat layers", "[imas][geometry][flat]") {
+  auto drQtz = GENERATE(0*mm, 30*mm);
+  auto& nested = *imas_demonstrator(nullptr, 70*cm, drQtz, 20*mm, false, true, false);
+  auto& flat   = *imas_demonstrator(nullptr, 70*cm, drQtz, 20*mm, false, true, true );
+
+  // Same volumes, but every layer sits directly in the envelope
+  CHECK(std::distance(begin(flat), end(flat)) == std::distance(begin(nested), end(nested)));
+  auto envelope = flat.GetLogicalVolume();
+  for (size_t n=0; n<envelope -> GetNoDaughters(); ++n) {
+    auto shell = envelope -> GetDaughter(n);
+    CHECK(dynamic_cast<G4Tubs*>(shell -> GetLogicalVolume() -> GetSolid()));
+    CHECK(shell -> CheckOverlaps(1000, 0, false) == false);
+  }
+
+  // Points along a radius lie in the same layers in both geometries
+  auto locate = [](auto& world, auto point) {
+    G4Navigator navigator;
+    navigator.SetWorldVolume(&world);
+    return navigator.LocateGlobalPointAndSetup(point) -> GetName();
+  };
+  auto geometry_manager = G4GeometryManager::GetInstance();
+  for (auto world : {&nested, &flat}) { geometry_manager -> CloseGeometry(true, false, world); }
+  for (auto r = 0.5*mm; r < 500*mm; r += 1*mm) {
+    G4ThreeVector point{r * std::cos(0.1), r * std::sin(0.1), 12*mm};
+    CHECK(locate(flat, point) == locate(nested, point));
+  }
+  for (auto world : {&nested, &flat}) { geometry_manager -> OpenGeometry(world); }
+}
+
+TEST_CASE("IMAS production cuts", "[imas][geometry][cuts]") {
+  // Nested layers: Steel_2 > Outer_vacuum > LXe > Steel_1 > Inner_vacuum > Steel_0 > Cavity
+  auto replicated = GENERATE(false, true);
+  auto world = imas_demonstrator(nullptr, 70*cm, 0, 20*mm, false, replicated, false);
+  auto logical = [world](G4String const& name) -> G4LogicalVolume* {
+    for (auto volume : *world) {
+      if (volume -> GetLogicalVolume() -> GetName() == name) { return volume -> GetLogicalVolume(); }
+    }
+    FAIL("No volume " << name);
+    return nullptr;
+  };
+  auto default_cut = G4ProductionCutsTable::GetProductionCutsTable() -> GetDefaultProductionCuts() -> GetProductionCut("gamma");
+  auto region_and_cut = [&](G4String const& name) {
+    // Regions only spread to the daughters of their roots when the material lists are updated
+    G4RegionStore::GetInstance() -> UpdateMaterialList(world);
+    auto region = logical(name) -> GetRegion();
+    REQUIRE(region);
+    return std::make_pair(region -> GetName(), region -> GetProductionCuts() -> GetProductionCut("gamma"));
+  };
+
+  SECTION("passive cut only: the scintillator keeps the default") {
+    set_detector_production_cuts(world, "LXe", 3*mm, 0);
+    CHECK(region_and_cut("Steel_1") == std::make_pair(G4String{"Passive"}     , 3*mm));
+    CHECK(region_and_cut("LXe"    ) == std::make_pair(G4String{"Scintillator"}, default_cut));
+    CHECK(region_and_cut("Cavity" ) == std::make_pair(G4String{"Detector_layers"}, default_cut));
+    // Not a copy: follows any later change to the defaults
+    auto defaults = G4ProductionCutsTable::GetProductionCutsTable() -> GetDefaultProductionCuts();
+    CHECK(logical("LXe") -> GetRegion() -> GetProductionCuts() == defaults);
+  }
+  SECTION("scintillator cut only: the inner layers keep the default") {
+    set_detector_production_cuts(world, "LXe", 0, 0.2*mm);
+    CHECK(region_and_cut("LXe"         ) == std::make_pair(G4String{"Scintillator"}   , 0.2*mm));
+    CHECK(region_and_cut("Steel_1"     ) == std::make_pair(G4String{"Passive"}        , default_cut));
+    CHECK(region_and_cut("Inner_vacuum") == std::make_pair(G4String{"Detector_layers"}, default_cut));
+    CHECK(region_and_cut("Cavity"      ) == std::make_pair(G4String{"Detector_layers"}, default_cut));
+    if (replicated) {
+      CHECK(region_and_cut("SiPM_sector") == std::make_pair(G4String{"Scintillator"}, 0.2*mm));
+    }
+  }
+}
@@ -7,15 +7,21 @@
 
 #include <G4Box.hh>
 #include <G4LogicalVolume.hh>
+#include <G4PVParameterised.hh>
+#include <G4PVReplica.hh>
+#include <G4ProductionCuts.hh>
+#include <G4ProductionCutsTable.hh>
 #include <G4RotationMatrix.hh>
 #include <G4ThreeVector.hh>
 #include <G4Tubs.hh>
 #include <G4Types.hh>
 #include <G4SystemOfUnits.hh>
 
+#include <algorithm>
 #include <initializer_list>
 #include <tuple>
 #include <optional>
+#include <vector>
 
 using CLHEP::pi;
 using CLHEP::twopi;
@@ -29,7 +35,9 @@ G4PVPlacement* imas_demonstrator(n4::sensitive_detector* sd,
                                  G4double length,
                                  G4double drQtz,
                                  G4double drLXe,
-                                 bool steel_is_vacuum) {
+                                 bool steel_is_vacuum,
+                                 bool replicated_sipms,
+                                 bool flat_layers) {
   // ----- Materials --------------------------------------------------------------
   auto air     = material("G4_AIR");
   auto steel   = material("G4_STAINLESS-STEEL");
@@ -43,14 +51,20 @@ G4PVPlacement* imas_demonstrator(n4::sensitive_detector* sd,
   }
 
   // ----- Utility for wrapping smaller cylinder inside a larger one --------------
+  // With flat_layers, each layer is instead an annular shell around the
+  // previous one: all shells will be placed side by side in the envelope, so
+  // locating a point never has to descend through all the layers.
   G4LogicalVolume*   log_out = nullptr; // Current outermost logical volume
   G4VPhysicalVolume* phy_prv = nullptr; // Physical volume directly inside log_out
+  std::vector<G4LogicalVolume*> shells;
   auto radius = 0.0;
-  auto layer = [=, &radius, &log_out, &phy_prv](auto& name, auto material, auto dr) {
+  auto layer = [=, &radius, &log_out, &phy_prv, &shells](auto& name, auto material, auto dr) {
     if (name == "Quartz" && drQtz == 0) { return; }
+    auto r_min = (flat_layers && log_out) ? radius : 0.0;
     radius += dr;
-    auto log_new = volume<G4Tubs>(name, material, 0.0, radius, length/2, 0.0, twopi);
-    if (log_out) { phy_prv = place(log_out).in(log_new).now(); }
+    auto log_new = volume<G4Tubs>(name, material, r_min, radius, length/2, 0.0, twopi);
+    if (flat_layers)  { shells.push_back(log_new); }
+    else if (log_out) { phy_prv = place(log_out).in(log_new).now(); }
     log_out = log_new;
   };
 
@@ -65,8 +79,8 @@ G4PVPlacement* imas_demonstrator(n4::sensitive_detector* sd,
   layer("Steel_2"     , steel ,   5   * mm);
 
   // Helper for placing sensors in different layers according to detector design version
-  auto place_sipms_in = [&sd](auto layer, optional<G4double> radius = {}) {
-    line_cylinder_with_tiles(layer, sipm_hamamatsu_blue(true, sd), 1 * mm, radius);
+  auto place_sipms_in = [&sd, replicated_sipms](auto layer, optional<G4double> radius = {}) {
+    line_cylinder_with_tiles(layer, sipm_hamamatsu_blue(true, sd), 1 * mm, radius, replicated_sipms);
   };
 
   // If Quartz layer missing, place sipms directly in LXe
@@ -77,7 +91,8 @@ G4PVPlacement* imas_demonstrator(n4::sensitive_detector* sd,
   auto env_width  = 1.1 * radius;
 
   auto vol_envelope = volume<G4Box>("Envelope", air, env_width, env_width, env_length);
-  place(log_out).in(vol_envelope).now();
+  if (flat_layers) { for (auto shell : shells) { place(shell).in(vol_envelope).now(); } }
+  else             {                             place(log_out).in(vol_envelope).now();  }
   return place(vol_envelope).now();
 }
 
@@ -109,7 +124,8 @@ auto angular_positioning(double outer_r, double dz, double pitch) {
 }
 
 // TODO: this is not adequately tested
-void line_cylinder_with_tiles(G4LogicalVolume* cylinder, G4LogicalVolume* tile, G4double gap, optional<G4double> r) {
+void line_cylinder_with_tiles(G4LogicalVolume* cylinder, G4LogicalVolume* tile, G4double gap, optional<G4double> r,
+                              bool replicated) {
 
   // Cylinder dimensions
   auto tub = dynamic_cast<G4Tubs*>(cylinder -> GetSolid());
@@ -125,6 +141,22 @@ void line_cylinder_with_tiles(G4LogicalVolume* cylinder, G4LogicalVolume* tile,
   auto z   =   axial_positioning(gap, length, dx);
   auto phi = angular_positioning(outer_r, dz, z.pitch);
 
+  if (replicated) {
+    // The ring must enclose the tiles' corners. It and its sectors are more of
+    // the cylinder (same material), see scintillator_volumes.
+    auto r_min  = phi.r - dz/2;
+    auto r_max  = std::sqrt(std::pow(phi.r + dz/2, 2) + std::pow(dx/2, 2));
+    auto medium = cylinder -> GetMaterial();
+    auto ring   = volume<G4Tubs>("SiPM_ring"  , medium, r_min, r_max, length/2,           0.0, twopi    );
+    auto sector = volume<G4Tubs>("SiPM_sector", medium, r_min, r_max, length/2, -phi.delta/2, phi.delta);
+    place(ring).in(cylinder).now();
+    // Sector n is centred on phi = pi/2 + n delta, like tile column n in the placement version
+    new G4PVReplica{"SiPM_sector", sector, ring, kPhi, static_cast<G4int>(phi.N), phi.delta, pi/2 - phi.delta/2};
+    auto column = new sipm_column{phi.r, z.first, z.pitch, z.N, phi.N, phi.delta};
+    new G4PVParameterised{tile -> GetName(), tile, sector, kZAxis, static_cast<G4int>(z.N), column};
+    return;
+  }
+
   //return;
   G4ThreeVector x_axis{1, 0, 0};
   G4ThreeVector z_axis{0, 0, 1};
@@ -149,6 +181,45 @@ void line_cylinder_with_tiles(G4LogicalVolume* cylinder, G4LogicalVolume* tile,
 }
 
 
+unsigned sipm_sensor_id(G4VTouchable const* touchable) {
+  auto tile = touchable -> GetVolume(1);
+  if (! tile -> IsParameterised()) { return touchable -> GetCopyNumber(1); }
+  return touchable -> GetCopyNumber(2) * tile -> GetMultiplicity() + touchable -> GetCopyNumber(1);
+}
+
+unsigned sipm_sensor_id(n4::geometry_catalogue const& catalogue, size_t tile) {
+  auto& entry = catalogue[tile];
+  if (! entry.volume -> IsParameterised()) { return entry.copy_no; }
+  return catalogue[entry.parent].copy_no * entry.volume -> GetMultiplicity() + entry.copy_no;
+}
+
+sipm_column::sipm_column(G4double r, G4double first_z, G4double pitch, size_t n_z, size_t n_phi, G4double d_phi)
+  : r{r}, first_z{first_z}, pitch{pitch}, n_z{n_z}, n_phi{n_phi}, d_phi{d_phi}
+{
+  // Tile orientation in the placement version is Rz(n delta) Rx(-pi/2). The
+  // sector is rotated by pi/2 + n delta, which leaves Rz(-pi/2) Rx(-pi/2).
+  G4RotationMatrix object_rotation;
+  object_rotation.rotateX(-pi/2);
+  object_rotation.rotateZ(-pi/2);
+  frame_rotation = object_rotation.inverse();
+}
+
+void sipm_column::ComputeTransformation(G4int copy_no, G4VPhysicalVolume* tile) const {
+  tile -> SetTranslation({r, 0, first_z + copy_no * pitch});
+  tile -> SetRotation(const_cast<G4RotationMatrix*>(&frame_rotation));
+}
+
+std::vector<std::pair<unsigned, G4ThreeVector>> sipm_column::sensor_positions() const {
+  std::vector<std::pair<unsigned, G4ThreeVector>> positions;
+  for (size_t n=0; n<n_phi; ++n) {
+    for (size_t k=0; k<n_z; ++k) {
+      auto p = G4ThreeVector{0, r, first_z + k * pitch}.rotateZ(n * d_phi);
+      positions.emplace_back(n * n_z + k, p);
+    }
+  }
+  return positions;
+}
+
 // Idealized version of detector: a shell of LXe floating in vacuum. Used for
 // very fast simulations (3-4 orders of magnitude speedup). Achieves speed by
 // not generating or propagating any secondaries, detecting gammas as soon as
@@ -169,3 +240,53 @@ G4PVPlacement* magic_detector() {
   n4::place(xenon) .in(envelope).now();
   return n4::place(envelope).now();
 };
+
+std::vector<G4LogicalVolume*> scintillator_volumes(G4VPhysicalVolume* world, G4String const& scintillator_name) {
+  std::vector<G4LogicalVolume*> found;
+  auto add = [&found](auto logical) {
+    if (std::find(begin(found), end(found), logical) == end(found)) { found.push_back(logical); }
+  };
+  for (auto volume : *world) {
+    if (volume -> GetLogicalVolume() -> GetName() == scintillator_name) { add(volume -> GetLogicalVolume()); }
+  }
+  // Descendants in the same medium, however they are named: appended while looping
+  for (size_t i=0; i<found.size(); ++i) {
+    auto logical = found[i];
+    for (size_t d=0; d<logical -> GetNoDaughters(); ++d) {
+      auto daughter = logical -> GetDaughter(d) -> GetLogicalVolume();
+      if (daughter -> GetMaterial() == logical -> GetMaterial()) { add(daughter); }
+    }
+  }
+  return found;
+}
+
+void set_detector_production_cuts(G4VPhysicalVolume* world, G4String const& scintillator_name,
+                                  G4double passive_cut, G4double scintillator_cut) {
+  auto scintillator = scintillator_volumes(world, scintillator_name);
+  std::vector<G4LogicalVolume*> passive, other;
+  for (auto volume : *world) {
+    auto logical = volume -> GetLogicalVolume();
+    auto name    = logical -> GetName();
+    auto add = [logical](auto& roots) {
+      if (std::find(begin(roots), end(roots), logical) == end(roots)) { roots.push_back(logical); }
+    };
+    if (std::find(begin(scintillator), end(scintillator), logical) != end(scintillator)) { continue; }
+    if      (name == "Steel_0" || name == "Steel_1" || name == "Steel_2") { add(passive); }
+    else if (name == "Cavity"  || name == "Inner_vacuum" ||
+             name == "Quartz"  || name == "Outer_vacuum")                  { add(other);   }
+  }
+
+  auto make_region = [](G4String const& name, std::vector<G4LogicalVolume*> const& roots, G4double cut) {
+    n4::region region{name};
+    for (auto root : roots) { region.add(root); }
+    if (cut > 0) { region.cut(cut); }
+    auto made = region.now();
+    if (cut > 0) { return; }
+    // The defaults themselves, so later changes to them apply here too, undoing
+    // any cuts the region was given before
+    made -> SetProductionCuts(G4ProductionCutsTable::GetProductionCutsTable() -> GetDefaultProductionCuts());
+  };
+  make_region("Passive"        , passive     , passive_cut);
+  make_region("Scintillator"   , scintillator, scintillator_cut);
+  make_region("Detector_layers", other       , 0);
+}
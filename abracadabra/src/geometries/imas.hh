@@ -4,15 +4,62 @@
 #include "nain4.hh"
 
 #include <G4PVPlacement.hh>
+#include <G4RotationMatrix.hh>
+#include <G4VPVParameterisation.hh>
+#include <G4VTouchable.hh>
 
 #include <optional>
+#include <utility>
+#include <vector>
 
 G4PVPlacement* imas_demonstrator(n4::sensitive_detector*, G4double length,
                                  G4double quartz_thickness, G4double xenon_thickness,
-                                 bool vacuum_before_xenon = false);
+                                 bool vacuum_before_xenon = false,
+                                 bool replicated_sipms    = false,
+                                 bool flat_layers         = false);
 
+// With `replicated`, rather than placing each tile individually, the tiles are
+// placed in a ring replicated in phi, each of whose sectors contains a
+// parameterised column of tiles along z. The ring (SiPM_ring) and its sectors
+// (SiPM_sector) have the cylinder's material. Sensor ids are the same in both
+// cases: use sipm_sensor_id to find them.
 void line_cylinder_with_tiles(G4LogicalVolume* cylinder, G4LogicalVolume* sipm,
-                              G4double gap, std::optional<G4double> r = {});
+                              G4double gap, std::optional<G4double> r = {},
+                              bool replicated = false);
+
+// Id of the sensor whose active region (depth 0) the touchable is in
+unsigned sipm_sensor_id(G4VTouchable const*);
+// Id of the sensor whose tile is this catalogue entry
+unsigned sipm_sensor_id(n4::geometry_catalogue const&, size_t tile);
+
+// Column of tiles along z, in one phi-sector of a replicated ring
+class sipm_column : public G4VPVParameterisation {
+public:
+  sipm_column(G4double r, G4double first_z, G4double pitch, size_t n_z, size_t n_phi, G4double d_phi);
+  void ComputeTransformation(G4int copy_no, G4VPhysicalVolume*) const override;
+  // Id and position (in the frame of the lined cylinder) of every tile in the ring
+  std::vector<std::pair<unsigned, G4ThreeVector>> sensor_positions() const;
+private:
+  G4double r, first_z, pitch;
+  size_t   n_z, n_phi;
+  G4double d_phi;
+  G4RotationMatrix frame_rotation; // Same for all tiles, in the frame of their sector
+};
 
 G4PVPlacement* magic_detector();
+
+// Every logical volume that is part of the scintillator: those named
+// `scintillator_name`, and their descendants in the same material, whatever
+// their names, such as the ring and sectors holding replicated SiPMs. Code
+// asking whether a volume is scintillator must check membership, not names.
+std::vector<G4LogicalVolume*> scintillator_volumes(G4VPhysicalVolume* world, G4String const& scintillator_name);
+
+// Independent production cuts in the detector layers of `world`: the steel
+// layers ("Passive" region), the scintillator ("Scintillator") and the other
+// layers ("Detector_layers"). All three are always region roots, because in the
+// nested geometry each layer contains the inner ones, which would otherwise
+// take the cuts of whichever region encloses them. A cut of 0 keeps the
+// physics list's default.
+void set_detector_production_cuts(G4VPhysicalVolume* world, G4String const& scintillator_name,
+                                  G4double passive_cut, G4double scintillator_cut);
 #endif
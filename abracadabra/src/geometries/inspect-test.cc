@@ -1,6 +1,7 @@
 #include <materials/LXe.hh>
 
 #include <geometries/inspect.hh>
+#include <random/random.hh>
 
 #include <nain4.hh>
 #include <g4-mandatory.hh>
@@ -11,38 +12,41 @@
 
 #include <catch2/catch.hpp>
 
+#include <vector>
+
 using n4::material;
 using n4::volume;
 using n4::place;
 
-TEST_CASE("geometry inspect", "[geometry][inspect]") {
-
-  // A geometry with a variety of materials
-  n4::geometry::construct_fn geometry = []() {
-    auto air     = material("G4_AIR");
-    auto steel   = material("G4_STAINLESS-STEEL");
-    auto vacuum  = material("G4_Galactic");
-    auto quartz  = quartz_with_properties();
-    auto lxe     = LXe_with_properties();
-
-    auto l = 10 * mm;
-    auto v_air    = volume<G4Tubs>("Air"   , air   , 0.0, 10.0*mm, l, 0.0, 360*deg);
-    auto v_steel  = volume<G4Tubs>("Steel" , steel , 0.0, 20.0*mm, l, 0.0, 360*deg);
-    auto v_vacuum = volume<G4Tubs>("Vacuum", vacuum, 0.0, 30.0*mm, l, 0.0, 360*deg);
-    auto v_quartz = volume<G4Tubs>("Quartz", quartz, 0.0, 40.0*mm, l, 0.0, 360*deg);
-    auto v_lxe    = volume<G4Tubs>("LXe"   , lxe   , 0.0, 50.0*mm, l, 0.0, 360*deg);
-    auto world    = volume<G4Box> ("World" , air   , 60*mm, 60*mm, 60*mm);
-
-    place(v_air)   .in(v_steel) .now();
-    place(v_steel) .in(v_vacuum).now();
-    place(v_vacuum).in(v_quartz).now();
-    place(v_quartz).in(v_lxe)   .now();
-    place(v_lxe)   .in(world)   .now();
-    return place(world)         .now();
-  };
+namespace {
+// A geometry with a variety of materials
+G4PVPlacement* nested_cylinders() {
+  auto air     = material("G4_AIR");
+  auto steel   = material("G4_STAINLESS-STEEL");
+  auto vacuum  = material("G4_Galactic");
+  auto quartz  = quartz_with_properties();
+  auto lxe     = LXe_with_properties();
+
+  auto l = 10 * mm;
+  auto v_air    = volume<G4Tubs>("Air"   , air   , 0.0, 10.0*mm, l, 0.0, 360*deg);
+  auto v_steel  = volume<G4Tubs>("Steel" , steel , 0.0, 20.0*mm, l, 0.0, 360*deg);
+  auto v_vacuum = volume<G4Tubs>("Vacuum", vacuum, 0.0, 30.0*mm, l, 0.0, 360*deg);
+  auto v_quartz = volume<G4Tubs>("Quartz", quartz, 0.0, 40.0*mm, l, 0.0, 360*deg);
+  auto v_lxe    = volume<G4Tubs>("LXe"   , lxe   , 0.0, 50.0*mm, l, 0.0, 360*deg);
+  auto world    = volume<G4Box> ("World" , air   , 60*mm, 60*mm, 60*mm);
+
+  place(v_air)   .in(v_steel) .now();
+  place(v_steel) .in(v_vacuum).now();
+  place(v_vacuum).in(v_quartz).now();
+  place(v_quartz).in(v_lxe)   .now();
+  place(v_lxe)   .in(world)   .now();
+  return place(world)         .now();
+}
+}
 
+TEST_CASE("geometry inspect", "[geometry][inspect]") {
   auto run_manager = G4RunManager::GetRunManager();
-  run_manager -> SetUserInitialization(new n4::geometry{geometry});
+  run_manager -> SetUserInitialization(new n4::geometry{nested_cylinders});
 
   // Suppress noise generated by run manager initialiation
   auto shush = std::make_unique<n4::silence>(G4cout);
@@ -72,3 +76,27 @@ TEST_CASE("geometry inspect", "[geometry][inspect]") {
   x = 45; CHECK(name_at(x) == "LXe")   ; CHECK(density_at(x) == Approx(2980.0));
 
 }
+
+// Hidden: run explicitly with `[micro]` or `[benchmark]`
+TEST_CASE("geometry inspect throughput", "[.benchmark][micro][inspect]") {
+  auto run_manager = G4RunManager::GetRunManager();
+  run_manager -> SetUserInitialization(new n4::geometry{nested_cylinders});
+  auto shush = std::make_unique<n4::silence>(G4cout);
+  world_geometry_inspector inspect{run_manager};
+  shush = nullptr;
+
+  // As in the phantom vertex generators: points scattered over the whole geometry
+  std::vector<G4ThreeVector> points;
+  for (auto i=0; i<1000; ++i) { points.emplace_back(uniform(-55, 55)*mm, uniform(-55, 55)*mm, uniform(-9, 9)*mm); }
+
+  BENCHMARK("material_at") {
+    G4double total = 0;
+    for (auto& p : points) { total += inspect.material_at(p) -> GetDensity(); }
+    return total;
+  };
+  BENCHMARK("volume_at") {
+    size_t total = 0;
+    for (auto& p : points) { total += inspect.volume_at(p) -> GetName().size(); }
+    return total;
+  };
+}
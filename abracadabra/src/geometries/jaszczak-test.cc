@@ -0,0 +1,36 @@
+#include "nain4.hh"
+
+#include "geometries/jaszczak.hh"
+
+#include <catch2/catch.hpp>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+
+TEST_CASE("Jaszczak rods", "[jaszczak][geometry]") {
+  std::unique_ptr<G4RunManager> no_run_manager;
+  auto phantom = build_jaszczak_phantom{no_run_manager, false}.build();
+  auto& geometry = *phantom.geometry();
+
+  std::map<std::string, std::set<G4LogicalVolume*>> logicals;
+  std::map<std::string, std::set<G4int>>            copy_numbers;
+  std::map<std::string, size_t>                     placements;
+  for (auto volume: geometry) {
+    auto name = volume -> GetName();
+    if (name.rfind("Rod-", 0) != 0) { continue; }
+    logicals    [name].insert(volume -> GetLogicalVolume());
+    copy_numbers[name].insert(volume -> GetCopyNo());
+    placements  [name] += 1;
+    CHECK(volume -> CheckOverlaps(100, 0, false) == false);
+  }
+
+  // Each of the 6 sectors places a single logical rod many times, with distinct copy numbers
+  CHECK(logicals.size() == 6);
+  for (auto& [name, volumes] : logicals) {
+    CHECK(volumes.size() == 1);
+    CHECK(placements[name] > 1);
+    CHECK(copy_numbers[name].size() == placements[name]);
+  }
+}
@@ -85,6 +85,10 @@ void jaszczak_phantom::rod_sector(unsigned long n, G4double r,
   // Basis vectors of rod lattice
   const auto Ax = 2.0, Ay = 0.0;
   const auto Bx = 1.0, By = sqrt(3);
+  // All rods in a sector are identical: share one logical volume between them
+  auto label = std::string("Rod-") + std::to_string(n);
+  auto rod = volume<G4Tubs>(label, material, 0.0, r, height_rods/2, 0.0, twopi);
+  auto copy_no = 0;
   auto a = 0;
   for (bool did_b=true ; did_b; a+=1) {
     did_b = false;
@@ -92,9 +96,7 @@ void jaszczak_phantom::rod_sector(unsigned long n, G4double r,
       auto x = (a*Ax + b*Bx) * d + dx;
       auto y = (a*Ay + b*By) * d + dy;
       if (sqrt(x*x + y*y) + r + margin >= radius_body) { break; }
-      auto label = std::string("Rod-") + std::to_string(n);
-      auto rod = volume<G4Tubs>(label, material, 0.0, r, height_rods/2, 0.0, twopi);
-      place(rod).in(body).at(x,y,z).rotate(around_z_axis).now();
+      place(rod).in(body).at(x,y,z).rotate(around_z_axis).name(label).copy_no(copy_no++).now();
     }
   }
 }
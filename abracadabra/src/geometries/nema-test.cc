@@ -2,12 +2,16 @@
 #include "geometries/nema.hh"
 #include "nain4.hh"
 
+#include <G4RandomDirection.hh>
 #include <G4VSolid.hh>
 #include <G4SystemOfUnits.hh>
 #include <G4UnitsTable.hh>
 
 #include <catch2/catch.hpp>
 
+#include <utility>
+#include <vector>
+
 TEST_CASE("NEMA4 phantom geometry", "[nema4][geometry]") {
   const G4double z_offset =  34.5 * mm;
   const G4double y_offset = -45.0 * mm;
@@ -240,6 +244,93 @@ TEST_CASE("NEMA7 phantom generate vertex", "[nema7][generator]") {
   // TODO
 }
 
+TEST_CASE("NEMA7 extruded body", "[nema7][geometry]") {
+  auto top_r = 147*mm, corner_r = 77*mm, half_length = 90*mm, tolerance = 0.1*mm;
+  auto union_   = nema_7_body_union   (top_r, corner_r, half_length);
+  auto extruded = nema_7_body_extruded(top_r, corner_r, half_length, tolerance);
+
+  // The polygon is inscribed in the union's outline: they may only disagree
+  // within `tolerance` of the union's surface
+  size_t disagreements = 0;
+  auto compare = [&](G4ThreeVector const& p) {
+    auto in_union    = union_   -> Inside(p);
+    auto in_extruded = extruded -> Inside(p);
+    if (in_union == in_extruded || in_union == kSurface || in_extruded == kSurface) { return; }
+    ++disagreements;
+    CHECK(in_union == kInside);
+    CHECK(union_ -> DistanceToOut(p) <= tolerance);
+  };
+  for (auto i=0; i<1000000; ++i) {
+    compare({uniform(-top_r, top_r), uniform(-corner_r, top_r), uniform(-half_length, half_length) * 1.1});
+  }
+  CHECK(disagreements < 1000);
+
+  // Where the corner arcs meet the straight base: densely, as the whole body
+  // sampling rarely lands within `tolerance` of them
+  auto corner_c_x = top_r - corner_r;
+  for (auto x_corner : {-corner_c_x, corner_c_x}) {
+    for (auto i=0; i<100000; ++i) {
+      compare({x_corner + uniform(-2, 2)*mm, -corner_r + uniform(-2, 2)*mm, uniform(-half_length, half_length)});
+    }
+  }
+}
+
+TEST_CASE("NEMA7 extruded body vertices", "[nema7][generator]") {
+  auto top_r = 147*mm, corner_r = 77*mm;
+  auto phantom = build_nema_7_phantom{}
+    .activity(1)
+    .top_radius(top_r)
+    .corner_radius(corner_r)
+    .extruded_body(true)
+    .build();
+  auto extruded = nema_7_body_extruded(top_r, corner_r, 1*mm);
+
+  // Vertices must fall inside the polygon, not in the slivers between its
+  // chords and the union's arcs. Body frame: origin at top half-disc centre
+  auto corner_c_y = (top_r - corner_r) / 2;
+  size_t outside = 0;
+  for (auto i=0; i<1000000; ++i) {
+    auto vertex = phantom.generate_vertex();
+    if (extruded -> Inside({vertex.x(), vertex.y() + corner_c_y, 0}) == kOutside) { ++outside; }
+  }
+  CHECK(outside == 0);
+}
+
+// Hidden: run explicitly with `[benchmark]`
+TEST_CASE("NEMA7 body navigation throughput", "[.benchmark][nema7]") {
+  auto top_r = 147*mm, corner_r = 77*mm, half_length = 90*mm;
+  auto union_   = nema_7_body_union   (top_r, corner_r, half_length);
+  auto extruded = nema_7_body_extruded(top_r, corner_r, half_length);
+
+  // The queries made by the navigator at each step in and around the body
+  std::vector<std::pair<G4ThreeVector, G4ThreeVector>> points_and_directions;
+  for (auto i=0; i<10000; ++i) {
+    G4ThreeVector p{uniform(-top_r, top_r), uniform(-corner_r, top_r), uniform(-half_length, half_length)};
+    points_and_directions.emplace_back(p * 1.2, G4RandomDirection());
+  }
+  auto navigate = [&](G4VSolid* solid) {
+    G4double total = 0; // Prevent the calls being optimized away
+    for (auto& [p, v] : points_and_directions) {
+      if (solid -> Inside(p) == kInside) { total += solid -> DistanceToOut(p, v) + solid -> DistanceToOut(p); }
+      else                               { total += solid -> DistanceToIn (p, v) + solid -> DistanceToIn (p); }
+    }
+    return total;
+  };
+  BENCHMARK("union")    { return navigate(union_);   };
+  BENCHMARK("extruded") { return navigate(extruded); };
+}
+
+// Hidden: run explicitly with `[micro]` or `[benchmark]`
+TEST_CASE("NEMA7 generate vertex throughput", "[.benchmark][micro][nema7]") {
+  auto phantom = build_nema_7_phantom{}
+    .sphereD(10*mm, 4).sphereD(13*mm, 4).sphereD(17*mm, 4).sphereD(22*mm, 4).sphereD(28*mm, 0).sphereD(37*mm, 0)
+    .activity(1)
+    .lungD(44.5*mm)
+    .build();
+
+  BENCHMARK("generate_vertex") { return phantom.generate_vertex(); };
+}
+
 TEST_CASE("generate 511 keV gammas", "[generate][511][gamma]") {
   // Vertex location and time
   auto where_x =  1.2*mm;
@@ -6,6 +6,8 @@
 #include "nain4.hh"
 
 #include <G4Box.hh>
+#include <G4ExtrudedSolid.hh>
+#include <G4GeomTools.hh>
 #include <G4Orb.hh>
 #include <G4Tubs.hh>
 #include <G4MultiUnion.hh>
@@ -180,6 +182,9 @@ nema_7_phantom build_nema_7_phantom::build() {
     weights.push_back(body_weight);
     sub_weights = {top_volume, corners_volume/2, corners_volume/2, base_volume};
   }
+  // The slivers lost to the extruded polygon (within tolerance of the arcs)
+  // are negligible in the weights, but must not receive vertices
+  if (extruded) { body_outline = nema_7_body_outline(top_r, corner_r); }
   pick_region     = biased_choice(    weights);
   pick_sub_region = biased_choice(sub_weights);
   return std::move(*this);
@@ -220,6 +225,29 @@ G4PVPlacement* nema_7_phantom::geometry() const {
 
   auto corner_c_x = top_r - corner_r;
   auto corner_c_y = - corner_c_x / 2;
+
+  auto body_solid = extruded
+    ? nema_7_body_extruded(top_r, corner_r, half_length)
+    : nema_7_body_union   (top_r, corner_r, half_length);
+  auto vol_body = new G4LogicalVolume(body_solid, water, "Body");
+
+  // Build and place spheres
+  for (const auto [count, sphere]: enumerate(spheres)) {
+    std::string name = "Source_" + std::to_string(count);
+    auto ball  = volume<G4Orb>(name, water, sphere.radius);
+    auto position = sphere_position(count) + G4ThreeVector{0, -corner_c_y, z_offset};
+    place(ball).in(vol_body).at(position).now();
+  }
+
+  // ----- Build geometry by organizing volumes in a hierarchy --------------------
+  place(vol_body).in(vol_envelope).at(0,  corner_c_y, -z_offset).now();
+  place(vol_lung).in(vol_body)    .at(0, -corner_c_y,  0       ).now();
+  return place(vol_envelope).now();
+}
+
+G4VSolid* nema_7_body_union(G4double top_r, G4double corner_r, G4double half_length) {
+  auto pi = 180 * deg;
+  auto corner_c_x = top_r - corner_r;
   auto base_half_x = corner_c_x;
   auto base_half_y = corner_r / 2;
   auto top_half = new G4Tubs("Top"   , 0.0, top_r   , half_length,  0, pi);
@@ -242,24 +270,39 @@ G4PVPlacement* nema_7_phantom::geometry() const {
   // auto vol_body = new G4LogicalVolume(body_solid, body_material, "Body");
 
   auto no_rot = nullptr;
-  auto union1     = new G4UnionSolid("union1", top_half, corner, no_rot, {-corner_c_x,          0  , 0});
-  auto union2     = new G4UnionSolid("union2", union1  , corner, no_rot, { corner_c_x,          0  , 0});
-  auto body_solid = new G4UnionSolid("Body"  , union2  , base  , no_rot, {        0  , -base_half_y, 0});
-
-  auto vol_body = new G4LogicalVolume(body_solid, water, "Body");
+  auto union1 = new G4UnionSolid("union1", top_half, corner, no_rot, {-corner_c_x,          0  , 0});
+  auto union2 = new G4UnionSolid("union2", union1  , corner, no_rot, { corner_c_x,          0  , 0});
+  return        new G4UnionSolid("Body"  , union2  , base  , no_rot, {        0  , -base_half_y, 0});
+}
 
-  // Build and place spheres
-  for (const auto [count, sphere]: enumerate(spheres)) {
-    std::string name = "Source_" + std::to_string(count);
-    auto ball  = volume<G4Orb>(name, water, sphere.radius);
-    auto position = sphere_position(count) + G4ThreeVector{0, -corner_c_y, z_offset};
-    place(ball).in(vol_body).at(position).now();
-  }
+// The outline is convex, so G4ExtrudedSolid can use its fast convex-prism
+// algorithms: cost grows with the number of polygon vertices, but does not
+// involve the repeated boolean-solid iterations of the union.
+std::vector<G4TwoVector> nema_7_body_outline(G4double top_r, G4double corner_r, G4double tolerance) {
+  auto pi = 180 * deg;
+  auto corner_c_x = top_r - corner_r;
+  std::vector<G4TwoVector> polygon;
+  // Arc from angle `start` to `stop`, excluding the end point, which is the
+  // start of the next arc or straight edge
+  auto arc = [&](G4double cx, G4double r, G4double start, G4double stop) {
+    auto max_step = 2 * std::acos(1 - std::min(tolerance / r, 1.0));
+    auto n = static_cast<size_t>(std::ceil(std::abs(stop - start) / max_step));
+    for (size_t i=0; i<n; ++i) {
+      auto angle = start + (stop - start) * i / n;
+      polygon.emplace_back(cx + r * std::cos(angle), r * std::sin(angle));
+    }
+  };
+  // Clockwise, as preferred by G4ExtrudedSolid, starting at the leftmost point
+  arc(          0,    top_r,  pi    ,  0    ); // Top: over the top, left to right
+  arc( corner_c_x, corner_r,  0     , -pi/2 ); // Right corner, down to the base
+  polygon.emplace_back(corner_c_x, -corner_r);  // End of the right corner: the base is straight
+  arc(-corner_c_x, corner_r, -pi/2  , -pi   ); // Along the base, then up the left corner
+  return polygon;
+}
 
-  // ----- Build geometry by organizing volumes in a hierarchy --------------------
-  place(vol_body).in(vol_envelope).at(0,  corner_c_y, -z_offset).now();
-  place(vol_lung).in(vol_body)    .at(0, -corner_c_y,  0       ).now();
-  return place(vol_envelope).now();
+G4VSolid* nema_7_body_extruded(G4double top_r, G4double corner_r, G4double half_length, G4double tolerance) {
+  auto polygon = nema_7_body_outline(top_r, corner_r, tolerance);
+  return new G4ExtrudedSolid("Body", polygon, half_length, {0, 0}, 1, {0, 0}, 1);
 }
 
 G4ThreeVector nema_7_phantom::generate_vertex_in_body() const {
@@ -303,11 +346,19 @@ G4ThreeVector nema_7_phantom::generate_vertex() const {
   } else { // The phantom's body
     do {
       local_position = generate_vertex_in_body();
-    } while (inside_lung(local_position) || inside_a_sphere(local_position));
+    } while (inside_lung(local_position) || inside_a_sphere(local_position) || outside_body(local_position));
   }
   return local_position + offset; // TODO: rotation!
 }
 
+// generate_vertex_in_body samples the exact (union) shape; the extruded body
+// is the inscribed polygon, so reject the slivers between chords and arcs.
+bool nema_7_phantom::outside_body(G4ThreeVector& position) const {
+  if (body_outline.empty()) { return false; }
+  auto corner_c_y = (top_r - corner_r) / 2; // Outline origin: centre of top half-disc
+  return ! G4GeomTools::PointInPolygon({position.x(), position.y() + corner_c_y}, body_outline);
+}
+
 bool nema_7_phantom::inside_lung(G4ThreeVector& position) const {
   auto r2 = lung_r * lung_r;
   auto x = position.x();
@@ -5,6 +5,8 @@
 #include "random/random.hh"
 
 #include <G4PVPlacement.hh>
+#include <G4TwoVector.hh>
+#include <G4VSolid.hh>
 
 #include <G4SystemOfUnits.hh>
 #include <G4Types.hh>
@@ -80,6 +82,20 @@ private:
 
 // ===== NEMA NU-2 2018 Section 7: Image Qualitiy, Accuracy of Corrections ==================
 
+// The body of the NEMA7 phantom: a half-disc on top of two quarter-discs
+// (corners) joined by a rectangle (base). Origin at the centre of the top
+// half-disc. Two implementations of the same shape:
+//
+// + union: exact, but slow to navigate (nested G4UnionSolids)
+// + extruded: convex G4ExtrudedSolid whose polygon approximates the arcs by
+//   chords, with a maximum sagitta (deviation from the true arc) of `tolerance`
+G4VSolid* nema_7_body_union   (G4double top_r, G4double corner_r, G4double half_length);
+G4VSolid* nema_7_body_extruded(G4double top_r, G4double corner_r, G4double half_length,
+                               G4double tolerance = 0.1 * mm);
+// The (clockwise) polygon used by nema_7_body_extruded
+std::vector<G4TwoVector> nema_7_body_outline(G4double top_r, G4double corner_r,
+                                             G4double tolerance = 0.1 * mm);
+
 class nema_7_phantom {
 
 public:
@@ -91,6 +107,7 @@ public:
   G4ThreeVector sphere_position(int n) const;
   bool inside_lung    (G4ThreeVector&) const;
   bool inside_a_sphere(G4ThreeVector&) const;
+  bool outside_body   (G4ThreeVector&) const;
   bool inside_this_sphere(size_t, G4ThreeVector&) const;
   bool inside_whole(G4ThreeVector&) const { return true; }
   std::optional<size_t> in_which_region(G4ThreeVector&) const;
@@ -112,6 +129,8 @@ protected:
   G4double half_length =  90.0*mm;
   G4double to_end      =  70.0*mm; // NEMA requires spheres at 7cm from phantom end
   G4bool evacuate      = false;    // Replace all materials in body with vacuum
+  G4bool extruded      = false;    // Use nema_7_body_extruded, rather than _union
+  std::vector<G4TwoVector> body_outline; // Empty unless extruded
   biased_choice pick_region{{}};
   biased_choice pick_sub_region{{}};
 
@@ -133,6 +152,7 @@ public:
   build_nema_7_phantom& inner_diameter(G4double d) { return inner_radius(d/2); }
   build_nema_7_phantom& spheres_from_end(G4double l) { to_end = l; return *this; }
   build_nema_7_phantom& vacuum_body     (G4bool v) { evacuate = v; return *this; }
+  build_nema_7_phantom& extruded_body   (G4bool e) { extruded = e; return *this; }
   nema_7_phantom build();
 };
 // ------------------------------------------------------------------------------------
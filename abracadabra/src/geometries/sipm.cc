@@ -2,10 +2,12 @@
 #include "geometries/sipm.hh"
 #include "g4-mandatory.hh"
 #include "materials/LXe.hh"
+#include "random/random.hh"
 
 #include <G4Box.hh>
 #include <G4LogicalVolume.hh>
 #include <G4EventManager.hh>
+#include <G4PhysicalConstants.hh>
 
 using nain4::place;
 using nain4::scale_by;
@@ -40,18 +42,25 @@ G4LogicalVolume* sipm::build() {
 }
 
 // ----- simp_sensitive implementations --------------------------------------------------
-sipm_sensitive::sipm_sensitive(G4String name, std::optional<std::string> h5_name)
+sipm_sensitive::sipm_sensitive(G4String name, sensor_id_fn sensor_id, std::optional<std::string> h5_name,
+                               std::pmr::memory_resource* memory)
   : G4VSensitiveDetector{name}
+  , hits{memory}
+  , steps{memory}
   , io{h5_name}
+  , sensor_id{std::move(sensor_id)}
 {
   n4::fully_activate_sensitive_detector(this);
 }
 
 G4bool sipm_sensitive::ProcessHits(G4Step* step, G4TouchableHistory* /*deprecated_parameter*/) {
-  hits.push_back(*step);
+  auto pre  = step -> GetPreStepPoint();
+  auto pos  = pre -> GetPosition();
+  auto time = pre -> GetGlobalTime();
+  auto wavelength = CLHEP::h_Planck * CLHEP::c_light / pre -> GetKineticEnergy();
+  hits.push_back({sensor_id(pre -> GetTouchable()), time, pos, wavelength});
+  if (keep_steps) { steps.push_back(*step); }
   if (io) {
-    auto pos  = step -> GetPreStepPoint() -> GetPosition();
-    auto time = step -> GetPreStepPoint() -> GetGlobalTime();
     io -> write_hit_info(0, pos.getX(), pos.getY(), pos.getZ(), time);
   }
   return true; // TODO what is the meaning of this?
@@ -59,8 +68,8 @@ G4bool sipm_sensitive::ProcessHits(G4Step* step, G4TouchableHistory* /*deprecate
 
 void sipm_sensitive::EndOfEvent(G4HCofThisEvent*){
   auto current_evt = G4EventManager::GetEventManager()->GetNonconstCurrentEvent();
-  auto data = new n4::event_data{std::move(hits)};
-  hits = {};
+  auto data = new n4::event_data{std::move(hits), std::move(steps)};
+  hits = {}; steps = {};
   current_evt->SetUserInformation(data);
 }
 
@@ -68,16 +77,59 @@ void sipm_sensitive::EndOfEvent(G4HCofThisEvent*){
 // Hamamatsu Blue: one example of a SiPM
 #include <G4SystemOfUnits.hh>
 
-// XXX This is not being used at the moment: PDE done in post-processing
-G4MaterialPropertiesTable* sipm_surface_properties() {
-  auto photon_energy = scale_by(eV,
+#include <algorithm>
+
+// ----- photon_detection_efficiency implementation -----------------------------------------
+photon_detection_efficiency::photon_detection_efficiency(std::vector<G4double> energies,
+                                                         std::vector<G4double> values)
+  : energies{std::move(energies)}
+  , values  {std::move(values)}
+  , max_    {*std::max_element(begin(this->values), end(this->values))}
+{
+  if (this->energies.size() != this->values.size()) { FATAL("PDE energies and values differ in size"); }
+}
+
+G4double photon_detection_efficiency::operator()(G4double energy) const {
+  if (energy <= energies.front()) { return values.front(); }
+  if (energy >= energies.back ()) { return values.back (); }
+  auto hi = std::upper_bound(begin(energies), end(energies), energy) - begin(energies);
+  auto lo = hi - 1;
+  auto fraction = (energy - energies[lo]) / (energies[hi] - energies[lo]);
+  return values[lo] + fraction * (values[hi] - values[lo]);
+}
+
+bool photon_detection_efficiency::survives_creation() const { return biased_coin(max_); }
+
+bool photon_detection_efficiency::detected_after_thinning(G4Track* photon) const {
+  if (biased_coin((*this)(photon -> GetKineticEnergy()) / max_)) { return true; }
+  photon -> SetTrackStatus(fStopAndKill); // Otherwise it would go on being tracked
+  return false;
+}
+
+// ----- Hamamatsu Blue PDE --------------------------------------------------------------------
+std::vector<G4double> hamamatsu_blue_pde_energies() {
+  return scale_by(eV,
     { 1.37760, 1.54980, 1.79687, 1.90745, 1.99974, 2.06640, 2.21400, 2.47968, 2.75520
     , 2.91727, 3.09960, 3.22036, 3.44400, 3.54240, 3.62526, 3.73446, 3.87450});
+}
+
+std::vector<G4double> hamamatsu_blue_pde_values() {
+  return { 0.0445, 0.1045 , 0.208  , 0.261  , 0.314  , 0.3435 , 0.420  , 0.505  , 0.528
+         , 0.502 , 0.460  , 0.4195 , 0.3145 , 0.2625 , 0.211  , 0.1055 , 0.026  };
+}
+
+photon_detection_efficiency const& hamamatsu_blue_pde() {
+  static const photon_detection_efficiency pde{hamamatsu_blue_pde_energies(), hamamatsu_blue_pde_values()};
+  return pde;
+}
+
+// XXX This is not being used at the moment: PDE done in post-processing, or
+// in the simulation with /abracadabra/pde_at_creation (see hamamatsu_blue_pde)
+G4MaterialPropertiesTable* sipm_surface_properties() {
+  auto photon_energy = hamamatsu_blue_pde_energies();
 
   return nain4::material_properties()
-    .add("EFFICIENCY",   photon_energy,
-         { 0.0445, 0.1045 , 0.208  , 0.261  , 0.314  , 0.3435 , 0.420  , 0.505  , 0.528
-         , 0.502 , 0.460  , 0.4195 , 0.3145 , 0.2625 , 0.211  , 0.1055 , 0.026  })
+    .add("EFFICIENCY",   photon_energy, hamamatsu_blue_pde_values())
     .add("REFLECTIVITY", photon_energy, 0)
     .done();
 }
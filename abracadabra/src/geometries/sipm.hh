@@ -8,7 +8,13 @@
 #include <G4OpticalSurface.hh>
 #include <G4ThreeVector.hh>
 #include <G4PVPlacement.hh>
+#include <G4Track.hh>
+#include <G4VTouchable.hh>
+
+#include <functional>
+#include <memory_resource>
 #include <string>
+#include <vector>
 
 
 // Abstract interface for sepecification and construction of SiPMs
@@ -82,18 +88,50 @@ private:
 // ----- Sensitive Detector ------------------------------------------------------------------------
 class sipm_sensitive : public G4VSensitiveDetector {
 public:
-  sipm_sensitive(G4String name) : sipm_sensitive{name, {}} {}
-  sipm_sensitive(G4String name, std::optional<std::string> h5_name);
+  // Numbering of sensors is up to the geometry (e.g. imas.hh's sipm_sensor_id):
+  // given the touchable of a hit's pre-step point
+  using sensor_id_fn = std::function<G4int(G4VTouchable const*)>;
+
+  sipm_sensitive(G4String name, sensor_id_fn sensor_id) : sipm_sensitive{name, std::move(sensor_id), {}} {}
+  // Hits and steps are allocated from `memory`: e.g. an n4::event_arena's
+  sipm_sensitive(G4String name, sensor_id_fn sensor_id, std::optional<std::string> h5_name,
+                 std::pmr::memory_resource* memory = std::pmr::get_default_resource());
   G4bool ProcessHits(G4Step* step, G4TouchableHistory*) override;
   void   EndOfEvent (G4HCofThisEvent*)                  override;
 
 public:
-  std::vector<G4Step> hits;
+  std::pmr::vector<n4::sensor_hit> hits;
+  bool                             keep_steps = false; // Debugging: also copy whole G4Steps
+  std::pmr::vector<G4Step>         steps;
   std::optional<hdf5_io> io; // TODO improve RAII
+private:
+  sensor_id_fn sensor_id;
+};
+
+// ----- Photon detection efficiency ---------------------------------------------------------------
+// Piecewise-linear PDE as a function of photon energy. Like G4's material
+// property vectors, it is clamped to the edge values outside the tabulated range.
+class photon_detection_efficiency {
+public:
+  photon_detection_efficiency(std::vector<G4double> energies, std::vector<G4double> values);
+  G4double operator()(G4double energy) const;
+  G4double max() const { return max_; }
+
+  // Applying the PDE in the simulation, in two stages whose product is the
+  // exact per-wavelength PDE: optical photons are thinned at creation by the
+  // maximum PDE, and those reaching a sensor by the wavelength-dependent
+  // remainder. Photons rejected on detection are killed.
+  bool survives_creation      (               ) const;
+  bool detected_after_thinning(G4Track* photon) const;
+private:
+  std::vector<G4double> energies;
+  std::vector<G4double> values;
+  G4double              max_;
 };
 
 // ----- One example of usage of the interface
 G4LogicalVolume* sipm_hamamatsu_blue(G4bool visible, G4VSensitiveDetector*);
+photon_detection_efficiency const& hamamatsu_blue_pde();
 
 
 #endif
@@ -8,7 +8,12 @@
 #include "utils/enumerate.hh"
 
 #include <G4Box.hh>
+#include <G4DynamicParticle.hh>
+#include <G4OpticalPhoton.hh>
 #include <G4ParticleGun.hh>
+#include <G4Step.hh>
+#include <G4TouchableHistory.hh>
+#include <G4Track.hh>
 #include <G4SystemOfUnits.hh>
 #include <G4UnitsTable.hh>
 
@@ -60,6 +65,29 @@ TEST_CASE("Hamamatsu blue invisible", "[geometry][hamamatsu][blue]") {
 
 }
 
+TEST_CASE("sipm_sensitive hit", "[hamamatsu][sensitive]") {
+  G4TouchableHandle touchable{new G4TouchableHistory};
+  G4VTouchable const* seen = nullptr;
+  sipm_sensitive sensitive{"sipm_sensitive_test", [&seen](auto t) { seen = t; return 42; }};
+
+  G4Step step;
+  auto pre = step.GetPreStepPoint();
+  pre -> SetPosition({1*mm, 2*mm, 3*mm});
+  pre -> SetGlobalTime(4.5*ns);
+  pre -> SetKineticEnergy(2.5*eV);
+  pre -> SetTouchableHandle(touchable);
+  sensitive.ProcessHits(&step, nullptr);
+
+  REQUIRE(sensitive.hits.size() == 1);
+  auto& hit = sensitive.hits.front();
+  CHECK(seen          == touchable());
+  CHECK(hit.sensor_id == 42);
+  CHECK(hit.time      == 4.5*ns);
+  CHECK(hit.position  == G4ThreeVector{1*mm, 2*mm, 3*mm});
+  CHECK(hit.wavelength == Approx(495.9*nm).epsilon(1e-4)); // hc / 2.5 eV
+  CHECK(sensitive.steps.empty()); // Only kept on request
+}
+
 // ----- TODO Needs to find a home --------------------------------------------------
 // Utility for connecting sensitive detector to hdf5 writer
 
@@ -73,10 +101,11 @@ public:
   {}
 
   bool process_hits(G4Step* step) {
-    hits.push_back(*step);
     auto pt = step -> GetPreStepPoint();
     auto p = pt -> GetPosition();
     auto t = pt -> GetGlobalTime();
+    auto wavelength = CLHEP::h_Planck * CLHEP::c_light / pt -> GetKineticEnergy();
+    hits.push_back({pt -> GetTouchable() -> GetCopyNumber(1), t, p, wavelength});
     writer.write_hit_info(0, p[0], p[1], p[2], t);
     return true;
   }
@@ -93,7 +122,7 @@ public:
   n4::sensitive_detector::end_of_event_fn const END_OF_EVENT;
 
 private:
-  std::vector<G4Step> hits{};
+  std::pmr::vector<n4::sensor_hit> hits{};
   hdf5_io& writer;
 
 };
@@ -198,3 +227,45 @@ TEST_CASE("hamamatsu app", "[app]") {
     // TODO: CHECK(row.event_id == ??);
   }
 }
+
+TEST_CASE("Hamamatsu blue PDE", "[hamamatsu][blue][pde]") {
+  auto& pde = hamamatsu_blue_pde();
+
+  // Tabulated values are reproduced exactly
+  CHECK(pde(1.37760 * eV) == Approx(0.0445));
+  CHECK(pde(2.75520 * eV) == Approx(0.528 ));
+  CHECK(pde(3.87450 * eV) == Approx(0.026 ));
+
+  // Linear interpolation between tabulated points
+  CHECK(pde((2.47968 + 2.75520) / 2 * eV) == Approx((0.505 + 0.528) / 2));
+
+  // Clamped to edge values outside the tabulated range, like G4 property vectors
+  CHECK(pde(1   * eV) == Approx(0.0445));
+  CHECK(pde(7.1 * eV) == Approx(0.026 ));
+
+  CHECK(pde.max() == Approx(0.528));
+
+}
+
+TEST_CASE("Hamamatsu blue PDE at creation", "[hamamatsu][blue][pde]") {
+  auto& pde = hamamatsu_blue_pde();
+  auto optical_photon = G4OpticalPhoton::Definition();
+
+  // Thinning by the maximum at creation and correcting on detection, gives the
+  // same fraction of detected photons as applying the full PDE. Photons
+  // rejected on detection are no longer tracked.
+  for (auto E : {1.5*eV, 2.0*eV, 2.5*eV, 3.0*eV, 3.5*eV}) {
+    size_t N = 1000000, detected = 0, rejected = 0, killed = 0, alive = 0;
+    for (size_t i=0; i<N; ++i) {
+      if (! pde.survives_creation()) { continue; }
+      G4Track photon{new G4DynamicParticle{optical_photon, {0, 0, 1}, E}, 0, {}};
+      photon.SetTrackStatus(fAlive);
+      auto is_detected = pde.detected_after_thinning(&photon);
+      ++(is_detected ? detected : rejected);
+      ++(photon.GetTrackStatus() == fStopAndKill ? killed : alive);
+    }
+    CHECK(static_cast<G4double>(detected) / N == Approx(pde(E)).epsilon(0.02));
+    CHECK(killed == rejected);
+    CHECK(alive  == detected);
+  }
+}
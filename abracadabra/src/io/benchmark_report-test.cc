@@ -0,0 +1,41 @@
+#include "io/benchmark_report.hh"
+
+#include <catch2/catch.hpp>
+
+#include <sstream>
+
+TEST_CASE("benchmark report", "[benchmark_report]") {
+  std::vector<benchmark_result> baseline{
+    {"sanity/imas/magic_0"            ,  10, 1e6, 300, 5000, 4.0},
+    {"nema_7/scintillator_LXe/magic_1", 500, 2e5, 250,  800, 2.5},
+  };
+
+  SECTION("round trip") {
+    std::stringstream file;
+    write_benchmark_report(file, baseline);
+    auto read = read_benchmark_report(file);
+    REQUIRE(read.size() == 2);
+    CHECK(read[1].cell              == "nema_7/scintillator_LXe/magic_1");
+    CHECK(read[1].events_per_second == 500);
+    CHECK(read[1].steps_per_second  == 2e5);
+    CHECK(read[1].init_seconds      == 2.5);
+  }
+
+  SECTION("regressions beyond tolerance") {
+    auto current = baseline;
+    current[0].events_per_second =  9.5; // Within 10%
+    current[0].peak_rss_mb       =  400; // Worse
+    current[1].steps_per_second  =  1e5; // Worse
+    current[1].bytes_per_event   =  100; // Better
+    current.push_back({"new/cell/magic_3", 1, 1, 1e9, 1e9, 1e9}); // Not in baseline
+
+    auto regressions = compare_benchmarks(current, baseline, 0.1);
+    REQUIRE(regressions.size() == 2);
+    CHECK(regressions[0].cell     == "sanity/imas/magic_0");
+    CHECK(regressions[0].metric   == "peak_rss_mb");
+    CHECK(regressions[0].baseline == 300);
+    CHECK(regressions[0].current  == 400);
+    CHECK(regressions[1].metric   == "steps_per_second");
+    CHECK(compare_benchmarks(baseline, baseline, 0).empty());
+  }
+}
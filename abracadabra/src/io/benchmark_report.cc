@@ -0,0 +1,73 @@
+#include "io/benchmark_report.hh"
+
+#include <istream>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+// Which way is better, for each metric
+struct metric {
+  const char* name;
+  double benchmark_result::* value;
+  bool higher_is_better;
+};
+
+const metric metrics[] = {
+  {"events_per_second", &benchmark_result::events_per_second, true },
+  {"steps_per_second" , &benchmark_result::steps_per_second , true },
+  {"peak_rss_mb"      , &benchmark_result::peak_rss_mb      , false},
+  {"bytes_per_event"  , &benchmark_result::bytes_per_event  , false},
+  {"init_seconds"     , &benchmark_result::init_seconds     , false},
+};
+}
+
+void write_benchmark_report(std::ostream& out, std::vector<benchmark_result> const& results) {
+  out << "cell";
+  for (auto& m : metrics) { out << '\t' << m.name; }
+  out << '\n';
+  for (auto& r : results) {
+    out << r.cell;
+    for (auto& m : metrics) { out << '\t' << r.*m.value; }
+    out << '\n';
+  }
+}
+
+std::vector<benchmark_result> read_benchmark_report(std::istream& in) {
+  std::string line;
+  std::getline(in, line); // Header
+  std::vector<benchmark_result> results;
+  while (std::getline(in, line)) {
+    if (line.empty()) { continue; }
+    std::istringstream fields{line};
+    benchmark_result r;
+    std::getline(fields, r.cell, '\t');
+    for (auto& m : metrics) {
+      if (! (fields >> r.*m.value)) { throw std::runtime_error{"Malformed benchmark report line: " + line}; }
+    }
+    results.push_back(r);
+  }
+  return results;
+}
+
+std::vector<benchmark_regression> compare_benchmarks(std::vector<benchmark_result> const& current,
+                                                     std::vector<benchmark_result> const& baseline,
+                                                     double tolerance) {
+  std::map<std::string, benchmark_result const*> by_cell;
+  for (auto& b : baseline) { by_cell[b.cell] = &b; }
+
+  std::vector<benchmark_regression> regressions;
+  for (auto& c : current) {
+    auto found = by_cell.find(c.cell);
+    if (found == by_cell.end()) { continue; }
+    auto& b = *found -> second;
+    for (auto& m : metrics) {
+      auto now = c.*m.value, then = b.*m.value;
+      auto worse = m.higher_is_better ? now < then * (1 - tolerance)
+                                      : now > then * (1 + tolerance);
+      if (worse) { regressions.push_back({c.cell, m.name, then, now}); }
+    }
+  }
+  return regressions;
+}
@@ -0,0 +1,35 @@
+#ifndef io_benchmark_report_hh
+#define io_benchmark_report_hh
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Results of the end-to-end benchmark (see benchmark.cc): one row per cell of
+// the configuration matrix, written as tab-separated values with a header.
+
+struct benchmark_result {
+  std::string cell; // e.g. "nema_7/imas/magic_1"
+  double events_per_second;
+  double steps_per_second;
+  double peak_rss_mb;
+  double bytes_per_event;
+  double init_seconds;
+};
+
+void                          write_benchmark_report(std::ostream&, std::vector<benchmark_result> const&);
+std::vector<benchmark_result>  read_benchmark_report(std::istream&);
+
+struct benchmark_regression {
+  std::string cell, metric;
+  double baseline, current;
+};
+
+// Metrics which are worse than in `baseline` by more than `tolerance` (a
+// fraction): lower rates, or more memory, output or initialization time.
+// Cells missing from either report are not compared.
+std::vector<benchmark_regression> compare_benchmarks(std::vector<benchmark_result> const& current,
+                                                     std::vector<benchmark_result> const& baseline,
+                                                     double tolerance);
+
+#endif
@@ -0,0 +1,64 @@
+#include "io/console_log.hh"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+
+TEST_CASE("console log", "[io][console_log]") {
+  std::ostringstream out;
+
+  SECTION("records are formatted in order") {
+    {
+      console_log log{16, out};
+      console_log::vertex v{7, 1, 0, 1, 2, 3, 4, 5.5, 511, 300, 0, {}, {}};
+      console_log::copy_name(v.process, "compt");
+      console_log::copy_name(v.volume , "a_volume_name_much_longer_than_the_space_available");
+      log.log(console_log::primary{7, false, 1, 2, 3, 4, 5, 6});
+      log.log(v);
+      log.flush();
+      CHECK(log.dropped() == 0);
+    }
+    auto text = out.str();
+    auto primary = text.find("      7 -------");
+    auto header  = text.find("event  parent");
+    auto vertex  = text.find("compt");
+    CHECK(primary < header);
+    CHECK(header  < vertex);
+    CHECK(vertex  != std::string::npos);
+    CHECK(text.find("a_volume_name_much_long") != std::string::npos); // Truncated
+    CHECK(text.find("much_longer")            == std::string::npos);
+  }
+
+  SECTION("records logged after the logger has gone idle are written") {
+    {
+      console_log log{16, out};
+      log.log(console_log::primary{1, true});
+      log.flush();
+      std::this_thread::sleep_for(std::chrono::milliseconds(20)); // Logger now waiting
+      log.log(console_log::primary{2, true});
+      log.flush();
+    }
+    CHECK(out.str() == "        1\n        2\n");
+  }
+
+  SECTION("nothing logged, nothing written") {
+    { console_log log{16, out}; log.flush(); }
+    CHECK(out.str().empty());
+  }
+
+  SECTION("everything is written when the log is destroyed") {
+    size_t dropped;
+    {
+      console_log log{4, out};
+      for (size_t i=0; i<1000; ++i) { log.log(console_log::primary{i, true}); }
+      dropped = log.dropped();
+    }
+    std::istringstream lines{out.str()};
+    size_t n = 0;
+    for (std::string line; std::getline(lines, line);) { n++; }
+    CHECK(n + dropped == 1000);
+  }
+}
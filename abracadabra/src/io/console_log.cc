@@ -0,0 +1,117 @@
+#include "io/console_log.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+
+using std::setw;
+
+console_log::console_log(size_t capacity, std::ostream& out)
+  : ring{capacity}
+  , out{out}
+{}
+
+console_log::~console_log() {
+  if (! logger.joinable()) { return; }
+  { std::lock_guard<std::mutex> lock{mutex}; stopping = true; }
+  wake.notify_one();
+  logger.join();
+}
+
+void console_log::log(record const& r) {
+  if (! logger.joinable()) { logger = std::thread{[this] { drain(); }}; }
+  if (! ring.try_push(r)) { dropped_++; return; }
+  logged++;
+  // Pairs with the fence in drain: either the logger sees this record before
+  // waiting, or we see that it is idle, and wake it
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (idle.load(std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> lock{mutex};
+    wake.notify_one();
+  }
+}
+
+void console_log::flush() {
+  while (written.load(std::memory_order_acquire) < logged) { std::this_thread::yield(); }
+}
+
+void console_log::copy_name(name& to, std::string_view from) {
+  auto n = std::min(from.size(), sizeof(name) - 1);
+  std::memcpy(to, from.data(), n);
+  to[n] = '\0';
+}
+
+// Formats whatever is available, writes it in one go, and only waits when
+// there is nothing to do
+void console_log::drain() {
+  record r;
+  while (true) {
+    auto done = stopping.load(); // Before popping: nothing logged after stopping
+    size_t n = 0;
+    while (ring.try_pop(r)) {
+      std::visit([this](auto const& r) { format(r); }, r);
+      n++;
+    }
+    if (n > 0) {
+      auto batch = text.str();
+      out.write(batch.data(), batch.size());
+      out.flush();
+      text.str("");
+      written.fetch_add(n, std::memory_order_release);
+    } else if (done) {
+      return;
+    } else {
+      std::unique_lock<std::mutex> lock{mutex};
+      idle.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      wake.wait(lock, [this] { return ! ring.empty() || stopping.load(); });
+      idle.store(false, std::memory_order_relaxed);
+    }
+  }
+}
+
+void console_log::format(vertex const& v) {
+  if (v.event_id != header_last_printed) {
+    text << "   event  parent  id            x    y    z     r     moved    preKE pstKE  dKE   deposited\n";
+    header_last_printed = v.event_id;
+    track_1_printed_this_event = false;
+  }
+
+  if (v.id == 1 && ! track_1_printed_this_event) {
+    track_1_printed_this_event = true;
+    text << '\n';
+  }
+
+  #define SETW(w,v) setw(w) << v
+  #define ROUND(p,v) std::setw(p) << (int) std::round(v)
+  text << std::setprecision(1) << std::fixed;
+  text << SETW(9, v.event_id)
+       << SETW(5, v.parent) << ' '
+       << SETW(5, v.id)
+       << SETW(6, v.process)
+       << "  ("
+       << ROUND(5,v.x) << ROUND(5,v.y) << ROUND(5,v.z) << " :" << ROUND(4,v.r)
+       << ") "
+       << SETW(7, v.moved) << "   "
+       << SETW(6, v.pre_KE)
+       << SETW(6, v.pst_KE)
+       << SETW(6, v.pre_KE-v.pst_KE)
+       << SETW(6, v.dep_E)
+       << SETW(14, v.volume) << ' '
+       << '\n';
+  #undef ROUND
+  #undef SETW
+}
+
+void console_log::format(primary const& p) {
+  text << std::setprecision(1) << std::fixed;
+  if (p.brief) {
+    text << setw(9) << p.event_id << '\n';
+    return;
+  }
+  text << '\n' << setw(9) << p.event_id << " -------  "
+       << setw(7) << p.x  << setw(7) << p.y  << setw(7) << p.z  << "     "
+       << setw(7) << p.px << setw(7) << p.py << setw(7) << p.pz
+       << "  --------------------------------\n";
+}
@@ -0,0 +1,82 @@
+#ifndef io_console_log_hh
+#define io_console_log_hh
+
+#include "utils/spsc_ring.hh"
+
+#include <G4Types.hh>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <variant>
+
+// Verbose per-event and per-vertex console output. The simulation thread only
+// copies plain records into a ring buffer; a background thread formats them
+// and writes them out in batches, without flushing each line. When the buffer
+// is full, records are dropped and counted rather than waiting for the
+// terminal.
+//
+// The background thread is only started by the first record, so jobs which
+// log nothing (verbosity 0) never have it; it sleeps while there is nothing
+// to write. Other writes to the same stream are not ordered with respect to
+// logged records unless preceded by flush().
+class console_log {
+public:
+  // Fixed-size copies of names, so that records never allocate
+  using name = char[24];
+
+  struct vertex {
+    size_t   event_id;
+    G4int    id, parent;
+    G4double x, y, z, r, moved, pre_KE, pst_KE, dep_E;
+    name     process, volume;
+  };
+
+  struct primary {
+    size_t   event_id;
+    bool     brief; // Only the event number
+    G4double x, y, z, px, py, pz;
+  };
+
+  using record = std::variant<vertex, primary>;
+
+  explicit console_log(size_t capacity = 1 << 16, std::ostream& out = std::cout);
+  ~console_log(); // Writes out everything still buffered
+
+  // Never blocks on the terminal
+  void log(record const&);
+  // Blocks until everything logged so far has been written: use before
+  // writing to `out` directly
+  void flush();
+  size_t dropped() const { return dropped_; }
+
+  static void copy_name(name& to, std::string_view from);
+
+private:
+  void drain();
+  void format(vertex  const&);
+  void format(primary const&);
+
+  spsc_ring<record>   ring;
+  std::ostream&       out;
+  std::ostringstream  text;  // Only used by the logger thread
+  size_t header_last_printed = -1;
+  bool   track_1_printed_this_event = false;
+
+  size_t              logged   = 0; // Only used by the simulation thread
+  size_t              dropped_ = 0; // Only used by the simulation thread
+  std::atomic<size_t> written{0};
+  std::atomic<bool>   stopping{false};
+  std::atomic<bool>   idle{false}; // The logger is waiting for `wake`
+  std::mutex              mutex;
+  std::condition_variable wake;
+  std::thread             logger; // Started by the first record
+};
+
+#endif
@@ -0,0 +1,84 @@
+// clang-format off
+
+#include "nain4.hh"
+
+#include "geometries/samples.hh"
+#include "io/geometry_cache.hh"
+
+#include <G4Box.hh>
+#include <G4ProductionCuts.hh>
+#include <G4Region.hh>
+#include <G4SystemOfUnits.hh>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+TEST_CASE("geometry cache file names", "[geometry_cache]") {
+  auto file = geometry_cache_file("cache", "imas LXe 40");
+  CHECK(file.rfind("cache/geometry-", 0) == 0);
+  CHECK(file == geometry_cache_file("cache", "imas LXe 40"));
+  CHECK(file != geometry_cache_file("cache", "imas LXe 30"));
+}
+
+#ifdef ABRACADABRA_GDML
+TEST_CASE("geometry cache round trip", "[geometry_cache][gdml]") {
+  auto sensitive = new n4::sensitive_detector{"cache_test", {}, {}};
+  auto original  = square_array_of_sipms(sensitive);
+  auto file = geometry_cache_file(std::tmpnam(nullptr), "square");
+
+  CHECK(! load_geometry_cache(file));
+  save_geometry_cache(file, original);
+  auto loaded = load_geometry_cache(file);
+  REQUIRE(loaded);
+
+  // Same volumes, with the same names and copy numbers
+  CHECK(std::distance(begin(loaded), end(loaded)) == std::distance(begin(original), end(original)));
+  auto o = begin(original), l = begin(loaded);
+  for (; o != end(original); ++o, ++l) {
+    CHECK((*l) -> GetName()   == (*o) -> GetName());
+    CHECK((*l) -> GetCopyNo() == (*o) -> GetCopyNo());
+  }
+
+  // Sensitive detectors are not stored, but can be reattached
+  auto sensitive_volumes = [](auto world) {
+    return std::count_if(begin(world), end(world),
+                         [](auto v) { return v -> GetLogicalVolume() -> GetSensitiveDetector() != nullptr; });
+  };
+  CHECK(sensitive_volumes(loaded) == 0);
+  attach_sensitive_detector(loaded, "pre_Quartz_window", sensitive);
+  CHECK(sensitive_volumes(loaded) == sensitive_volumes(original));
+  CHECK(sensitive_volumes(loaded) > 0);
+
+  std::remove(file.c_str());
+}
+
+TEST_CASE("geometry cache regions", "[geometry_cache][gdml]") {
+  auto air     = n4::material("G4_AIR");
+  auto water   = n4::material("G4_WATER");
+  auto inner   = n4::volume<G4Box>("Cache_test_inner", water, 1*cm, 1*cm, 1*cm);
+  auto outer   = n4::volume<G4Box>("Cache_test_outer", air  , 2*cm, 2*cm, 2*cm);
+  n4::place(inner).in(outer).now();
+  auto original = n4::place(outer).now();
+  auto region = n4::region("Cache_test").add(inner).cut(1.5*mm).cut("e-", 0.3*mm).now();
+  auto file = geometry_cache_file(std::tmpnam(nullptr), "regions");
+  save_geometry_cache(file, original);
+
+  region -> SetName("Cache_test_original"); // As if in a new job
+  auto loaded = load_geometry_cache(file);
+  REQUIRE(loaded);
+  auto found = n4::find_region("Cache_test", false);
+  REQUIRE(found);
+  REQUIRE(found -> GetNumberOfRootVolumes() == 1);
+  CHECK((*found -> GetRootLogicalVolumeIterator()) -> GetName() == "Cache_test_inner");
+  auto cuts = found -> GetProductionCuts();
+  REQUIRE(cuts);
+  CHECK(cuts -> GetProductionCut("gamma") == Approx(1.5*mm));
+  CHECK(cuts -> GetProductionCut("e-"   ) == Approx(0.3*mm));
+  CHECK(cuts -> GetProductionCut("e+"   ) == Approx(1.5*mm));
+
+  std::remove(file.c_str());
+}
+#endif
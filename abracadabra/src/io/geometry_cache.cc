@@ -0,0 +1,64 @@
+#include "io/geometry_cache.hh"
+
+#include "nain4.hh"
+#include "utils/stable_hash.hh"
+
+#ifdef ABRACADABRA_GDML
+#include <G4GDMLParser.hh>
+#endif
+
+#include <cstdio>
+#include <filesystem>
+#include <unistd.h>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+std::string geometry_cache_file(std::string const& directory, std::string const& key) {
+  return (fs::path{directory} / ("geometry-" + stable_hash_hex(key) + ".gdml")).string();
+}
+
+#ifdef ABRACADABRA_GDML
+
+G4VPhysicalVolume* load_geometry_cache(std::string const& file) {
+  if (! fs::exists(file)) { return nullptr; }
+  G4GDMLParser parser;
+  parser.SetStripFlag(true); // Strip the pointer suffixes which Write adds to names (the default)
+  parser.Read(file, false);  // No schema validation: we wrote the file ourselves
+  return parser.GetWorldVolume();
+}
+
+void save_geometry_cache(std::string const& file, G4VPhysicalVolume* world) {
+  auto directory = fs::path{file}.parent_path();
+  if (! directory.empty()) { fs::create_directories(directory); }
+  auto tmp = file + ".tmp-" + std::to_string(getpid());
+  G4GDMLParser parser;
+  parser.SetRegionExport(true); // e.g. the phantom's, from combine_geometries
+  parser.Write(tmp, world);
+  if (std::rename(tmp.c_str(), file.c_str()) != 0) {
+    FATAL(("Failed to move geometry cache into place: " + file).c_str());
+  }
+}
+
+#else
+
+G4VPhysicalVolume* load_geometry_cache(std::string const&) {
+  FATAL("Geometry cache needs Geant4 with GDML support");
+  return nullptr;
+}
+
+void save_geometry_cache(std::string const&, G4VPhysicalVolume*) {
+  FATAL("Geometry cache needs Geant4 with GDML support");
+}
+
+#endif
+
+void attach_sensitive_detector(G4VPhysicalVolume* world, G4String const& name, G4VSensitiveDetector* sd) {
+  std::unordered_set<G4LogicalVolume*> done;
+  for (auto volume : *world) {
+    auto logical = volume -> GetLogicalVolume();
+    if (logical -> GetName() == name && done.insert(logical).second) {
+      logical -> SetSensitiveDetector(sd);
+    }
+  }
+}
@@ -0,0 +1,42 @@
+#ifndef io_geometry_cache_hh
+#define io_geometry_cache_hh
+
+#include <G4String.hh>
+#include <G4VPhysicalVolume.hh>
+#include <G4VSensitiveDetector.hh>
+
+#include <string>
+
+// GDML snapshots of fully constructed worlds, so that repeated jobs with the
+// same geometry parameters can skip building it from code. Only available
+// when Geant4 was built with GDML support (ABRACADABRA_GDML).
+//
+// The key should describe everything the geometry depends on: files are named
+// after its hash. Snapshots are not invalidated by changes to the geometry
+// code: empty the cache directory after making any.
+//
+// A loaded world has not been through the code which built it (e.g.
+// n4::combine_geometries), so anything which that code attaches to volumes
+// without GDML recording it must be re-applied by the caller after a load:
+//
+// + sensitive detectors: see attach_sensitive_detector
+// + fast simulation models, and production cuts which differ from those at
+//   the time of writing: best applied to built and loaded worlds alike
+//
+// Regions are exported, together with their root volumes (e.g. "Phantom",
+// from n4::combine_geometries) and the cuts they had when the file was written.
+
+std::string geometry_cache_file(std::string const& directory, std::string const& key);
+
+// nullptr if the file does not exist
+G4VPhysicalVolume* load_geometry_cache(std::string const& file);
+
+// Written to a temporary file which is then renamed, so concurrent jobs never
+// see a partial snapshot
+void save_geometry_cache(std::string const& file, G4VPhysicalVolume* world);
+
+// GDML does not record sensitive detectors: give `sd` back to every logical
+// volume called `name`
+void attach_sensitive_detector(G4VPhysicalVolume* world, G4String const& name, G4VSensitiveDetector* sd);
+
+#endif
@@ -0,0 +1,83 @@
+#include "io/hdf5.hh"
+
+#include <catch2/catch.hpp>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+TEST_CASE("hdf5 bulk writing", "[io][hdf5]") {
+  std::string file_name = std::tmpnam(nullptr) + std::string("-test.h5");
+  std::vector<vertex_t> batch;
+  for (u32 i=0; i<5; ++i) { batch.push_back({0, i, 0, 1, 2, 3, 4, 0.5, 511, 300, 211, 0, i}); }
+  std::vector<f16> times{1.5, 2.5, 3.5};
+  {
+    hdf5_io writer{file_name};
+    writer.write_vertex(7, 1, 0, 1, 2, 3, 4, 0.5, 511, 300, 211, 2, 3);
+    writer.append(batch);
+    writer.write_waveform(7, 42, times);
+  } // Flushed on destruction
+
+  HighFive::File file{file_name, HighFive::File::ReadOnly};
+  std::vector<vertex_t> vertices;
+  std::vector<waveform_t> waveform;
+  file.getGroup("MC").getDataSet("vertices").read(vertices);
+  file.getGroup("MC").getDataSet("waveform").read(waveform);
+
+  REQUIRE(vertices.size() == 6);
+  CHECK(vertices[0].event_id   == 7);
+  CHECK(vertices[0].volume_id  == 3);
+  for (u32 i=0; i<5; ++i) { CHECK(vertices[1 + i].track_id == i); CHECK(vertices[1 + i].volume_id == i); }
+
+  REQUIRE(waveform.size() == 3);
+  for (size_t i=0; i<3; ++i) {
+    CHECK(waveform[i].event_id  == 7);
+    CHECK(waveform[i].sensor_id == 42);
+    CHECK(waveform[i].time      == times[i]);
+  }
+  std::remove(file_name.c_str());
+}
+
+TEST_CASE("hdf5 optional tables", "[io][hdf5]") {
+  std::string without = std::tmpnam(nullptr) + std::string("-test.h5");
+  std::string with    = std::tmpnam(nullptr) + std::string("-test.h5");
+  { hdf5_io writer{without}; }
+  { hdf5_io writer{with   }; writer.write_event_cost({3, 0.5}); writer.write_step_profile("LXe", "compt", "gamma", 10, 8, 2, 0.25); }
+
+  CHECK(! HighFive::File{without, HighFive::File::ReadOnly}.getGroup("MC").exist("event_cost"));
+  CHECK(! HighFive::File{without, HighFive::File::ReadOnly}.getGroup("MC").exist("step_profile"));
+  std::vector<event_cost_t> cost;
+  HighFive::File{with, HighFive::File::ReadOnly}.getGroup("MC").getDataSet("event_cost").read(cost);
+  REQUIRE(cost.size() == 1);
+  CHECK(cost[0].event_id == 3);
+  CHECK(cost[0].seconds  == 0.5);
+  std::vector<step_profile_t> profile;
+  HighFive::File{with, HighFive::File::ReadOnly}.getGroup("MC").getDataSet("step_profile").read(profile);
+  REQUIRE(profile.size() == 1);
+  CHECK(std::string{profile[0].process} == "compt");
+  CHECK(profile[0].timeable == 8);
+  CHECK(profile[0].seconds  == 0.25);
+  std::remove(without.c_str());
+  std::remove(with   .c_str());
+}
+
+// Hidden: run explicitly with `[micro]` or `[benchmark]`
+TEST_CASE("hdf5 vertex writing throughput", "[.benchmark][micro][hdf5]") {
+  std::string file_name = std::tmpnam(nullptr) + std::string("-test.h5");
+  {
+    hdf5_io writer{file_name};
+    u32 event_id = 0;
+    // Mostly buffering, with a flush to the file every 32 chunks
+    BENCHMARK("write_vertex") {
+      writer.write_vertex(event_id++, 1, 0, 1, 2, 3, 4, 0.5, 511, 300, 211, 0, 0);
+      return event_id;
+    };
+    // A typical event's worth of vertices at once
+    std::vector<vertex_t> event(20, vertex_t{0, 1, 0, 1, 2, 3, 4, 0.5, 511, 300, 211, 0, 0});
+    BENCHMARK("append 20 vertices") {
+      writer.append(event);
+      return event.size();
+    };
+  }
+  std::remove(file_name.c_str());
+}
@@ -76,15 +76,71 @@ HF::CompoundType create_hit_type() {
 }
 HIGHFIVE_REGISTER_TYPE(hit_t, create_hit_type)
 
+HF::CompoundType create_weight_type() {
+  return {{"event_id", hdf_t<u32>{}},
+          {"weight"  , hdf_t<f32>{}}};
+}
+HIGHFIVE_REGISTER_TYPE(weight_t, create_weight_type)
+
+HF::CompoundType create_event_cost_type() {
+  return {{"event_id"       , hdf_t<u32>{}},
+          {"seconds"        , hdf_t<f32>{}},
+          {"tracks"         , hdf_t<u32>{}},
+          {"steps_gamma"    , hdf_t<u32>{}},
+          {"steps_electron" , hdf_t<u32>{}},
+          {"steps_positron" , hdf_t<u32>{}},
+          {"steps_optical"  , hdf_t<u32>{}},
+          {"steps_other"    , hdf_t<u32>{}},
+          {"optical_created", hdf_t<u32>{}},
+          {"stage_2"        , hdf_t<u32>{}}};
+}
+HIGHFIVE_REGISTER_TYPE(event_cost_t, create_event_cost_type)
+
+HF::CompoundType create_step_profile_type() {
+  return {{"volume"  , hdf_t<char[CONFLEN]>{}},
+          {"process" , hdf_t<char[CONFLEN]>{}},
+          {"particle", hdf_t<char[CONFLEN]>{}},
+          {"steps"   , hdf_t<u64>{}},
+          {"timeable", hdf_t<u64>{}},
+          {"sampled" , hdf_t<u64>{}},
+          {"seconds" , hdf_t<f64>{}}};
+}
+HIGHFIVE_REGISTER_TYPE(step_profile_t, create_step_profile_type)
+
 HF::CompoundType create_runinfo_type() {
   return {{"param_key"  , hdf_t<char[CONFLEN]>{}},
           {"param_value", hdf_t<char[CONFLEN]>{}}};
 }
 HIGHFIVE_REGISTER_TYPE(run_info_t, create_runinfo_type)
 
+HF::CompoundType create_light_map_binning_type() {
+  return {{"n_r"   , hdf_t<u32>{}},
+          {"n_phi" , hdf_t<u32>{}},
+          {"n_z"   , hdf_t<u32>{}},
+          {"r_min" , hdf_t<f64>{}},
+          {"r_max" , hdf_t<f64>{}},
+          {"half_z", hdf_t<f64>{}}};
+}
+HIGHFIVE_REGISTER_TYPE(light_map_binning_t, create_light_map_binning_type)
+
+HF::CompoundType create_light_map_voxel_type() {
+  return {{"voxel"    , hdf_t<u32>{}},
+          {"n_emitted", hdf_t<u64>{}}};
+}
+HIGHFIVE_REGISTER_TYPE(light_map_voxel_t, create_light_map_voxel_type)
+
+HF::CompoundType create_light_map_response_type() {
+  return {{"voxel"     , hdf_t<u32>{}},
+          {"sensor_id" , hdf_t<u32>{}},
+          {"n_detected", hdf_t<u64>{}},
+          {"sum_t"     , hdf_t<f64>{}},
+          {"sum_t2"    , hdf_t<f64>{}}};
+}
+HIGHFIVE_REGISTER_TYPE(light_map_response_t, create_light_map_response_type)
+
 void set_string_param(char * to, const char * from, u32 max_len) {
   memset(to, 0, max_len);
-  strcpy(to, from);
+  strncpy(to, from, max_len - 1); // Truncated, always terminated
 }
 
 run_info_t make_run_info_t(const char* param_key, const char* param_value) {
@@ -114,8 +170,8 @@ void hdf5_io::write_hit_info(u32 event_id, f16 x, f16 y, f16 z, f16 time) {
   buf_hits({event_id, x, y, z, time});
 }
 
-void hdf5_io::write_waveform(u32 event_id, u32 sensor_id, const std::vector<f16>& times) {
-  for (auto time: times) { buf_waveform({event_id, sensor_id, time}); }
+void hdf5_io::write_waveform(u32 event_id, u32 sensor_id, contiguous<f16> times) {
+  buf_waveform.append(times.size(), [&](size_t i) { return waveform_t{event_id, sensor_id, times.data()[i]}; });
 }
 
 void hdf5_io::write_total_charge(u32 event_id, u32 sensor_id, u32 charge) {
@@ -126,6 +182,29 @@ void hdf5_io::write_sensor_xyz(u32 sensor_id, f16 x, f16 y, f16 z) {
   buf_sensors({sensor_id, x, y, z});
 }
 
+void hdf5_io::write_weight(u32 event_id, f32 weight) {
+  buf_weight({event_id, weight});
+}
+
+void hdf5_io::write_event_cost(event_cost_t const& cost) {
+  if (! buf_cost) { buf_cost.emplace(file, "MC", "event_cost", create_event_cost_type()); }
+  (*buf_cost)(event_cost_t{cost});
+}
+
+void hdf5_io::write_step_profile(std::string const& volume, std::string const& process, std::string const& particle,
+                                 u64 steps, u64 timeable, u64 sampled, f64 seconds) {
+  step_profile_t row;
+  set_string_param(row.volume  , volume  .c_str(), CONFLEN);
+  set_string_param(row.process , process .c_str(), CONFLEN);
+  set_string_param(row.particle, particle.c_str(), CONFLEN);
+  row.steps    = steps;
+  row.timeable = timeable;
+  row.sampled  = sampled;
+  row.seconds  = seconds;
+  if (! buf_profile) { buf_profile.emplace(file, "MC", "step_profile", create_step_profile_type()); }
+  (*buf_profile)(std::move(row));
+}
+
 void hdf5_io::write_primary(u32 event_id, f16 x, f16 y, f16 z, f16 px, f16 py, f16 pz) {
   buf_primary({event_id, x, y, z, px, py, pz});
 }
@@ -145,6 +224,37 @@ void hdf5_io::write_vertex(u32 event_id, u32 track_id, u32 parent_id,
     });
 }
 
+// Create a table and fill it with `data`, in one go
+template<class T>
+void write_whole_table(HF::File& file, std::string const& group_name, std::string const& dataset_name,
+                       HF::CompoundType const& type, std::vector<T> const& data) {
+  auto dataset = create_dataset(file, group_name, dataset_name, type);
+  if (data.empty()) { return; }
+  dataset.resize({data.size()});
+  dataset.select({0}, {data.size()}).write(data);
+}
+
+void hdf5_io::write_light_map(light_map_binning_t const& binning,
+                              std::vector<light_map_voxel_t   > const& voxels,
+                              std::vector<light_map_response_t> const& responses) {
+  write_whole_table(file, "light_map", "binning"  , create_light_map_binning_type (), std::vector{binning});
+  write_whole_table(file, "light_map", "voxels"   , create_light_map_voxel_type   (), voxels);
+  write_whole_table(file, "light_map", "responses", create_light_map_response_type(), responses);
+}
+
+hdf5_io::light_map_tables hdf5_io::read_light_map(std::string const& file_name) {
+  std::vector<light_map_binning_t > binning;
+  std::vector<light_map_voxel_t   > voxels;
+  std::vector<light_map_response_t> responses;
+  HF::File  the_file = HF::File{file_name, HF::File::ReadOnly};
+  HF::Group group    = the_file.getGroup("light_map");
+  group.getDataSet("binning"  ).read(binning);
+  group.getDataSet("voxels"   ).read(voxels);
+  group.getDataSet("responses").read(responses);
+  if (binning.size() != 1) { throw "Light map " + file_name + " should contain exactly one binning"; }
+  return {binning[0], std::move(voxels), std::move(responses)};
+}
+
 std::vector<hit_t> hdf5_io::read_hit_info(std::string const& file_name) {
   std::vector<hit_t> hits;
   // Get the table from the file
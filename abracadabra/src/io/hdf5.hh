@@ -6,14 +6,21 @@
 #include <highfive/H5DataSpace.hpp>
 #include <highfive/H5DataType.hpp>
 
+#include <atomic>
 #include <iostream>
+#include <iterator>
+#include <optional>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 #include <cstdint>
 
 // TODO: make this reliable across different architectures
 using f32 = float;
+using f64 = double;
 using u32 = uint32_t;
+using u64 = uint64_t;
 
 // TODO: most of our data don't need 32 bit precision, so we could save a lot of
 // space in the tables we write, if only the C++/HDF5 interface could express
@@ -115,12 +122,60 @@ struct hit_t {
 };
 HIGHFIVE_DECLARATIONS(hit_t, create_hit_type)
 
+// Weight of each event, when the generator biases its primaries
+struct weight_t {
+  u32 event_id;
+  f32 weight;
+};
+HIGHFIVE_DECLARATIONS(weight_t, create_weight_type)
+
+// Cost of simulating each event, when profiling: see /abracadabra/event_cost
+struct event_cost_t {
+  u32 event_id;
+  f32 seconds;
+  u32 tracks;
+  u32 steps_gamma, steps_electron, steps_positron, steps_optical, steps_other;
+  u32 optical_created;
+  u32 stage_2; // Were secondaries simulated?
+};
+HIGHFIVE_DECLARATIONS(event_cost_t, create_event_cost_type)
+
+// Where stepping time goes, when profiling: see /abracadabra/step_profile
+struct step_profile_t {
+  char volume  [CONFLEN];
+  char process [CONFLEN];
+  char particle[CONFLEN];
+  u64 steps, timeable, sampled; // Timeable: not the first step of a track
+  f64 seconds; // Of the timeable steps, estimated from the sampled ones
+};
+HIGHFIVE_DECLARATIONS(step_profile_t, create_step_profile_type)
+
 struct run_info_t {
   char param_key  [CONFLEN];
   char param_value[CONFLEN];
 };
 HIGHFIVE_DECLARATIONS(run_info_t, create_runinfo_type)
 
+// Light response of the scintillator: see fastsim/light_map.hh
+struct light_map_binning_t {
+  u32 n_r, n_phi, n_z;
+  f64 r_min, r_max, half_z;
+};
+HIGHFIVE_DECLARATIONS(light_map_binning_t, create_light_map_binning_type)
+
+struct light_map_voxel_t {
+  u32 voxel;
+  u64 n_emitted;
+};
+HIGHFIVE_DECLARATIONS(light_map_voxel_t, create_light_map_voxel_type)
+
+struct light_map_response_t {
+  u32 voxel, sensor_id;
+  u64 n_detected;
+  f64 sum_t, sum_t2;
+};
+HIGHFIVE_DECLARATIONS(light_map_response_t, create_light_map_response_type)
+
 #undef HIGHFIVE_DECLARATIONS
 // --------------------------------------------------------------------------------
 
@@ -130,6 +185,33 @@ HighFive::DataSet create_dataset(HighFive::File             file,
                                  HighFive::CompoundType const& type,
                                  hsize_t chunk_size = 32768);
 
+// Totals over all tables, for live job metrics: may be read from another thread
+struct hdf5_written {
+  static inline std::atomic<u64> rows{0}, bytes{0};
+  static void add(size_t n_rows, size_t row_size) {
+    rows .fetch_add(n_rows           , std::memory_order_relaxed);
+    bytes.fetch_add(n_rows * row_size, std::memory_order_relaxed);
+  }
+};
+
+// Read-only view of contiguous records: std::span, until we have C++20. Made
+// implicitly from any contiguous container (std::vector, std::pmr::vector,
+// std::array ...), or from a pointer and a size.
+template<class T>
+struct contiguous {
+  contiguous(T const* data, size_t size) : data_{data}, size_{size} {}
+  template<class C, class = decltype(std::data(std::declval<C const&>()))>
+  contiguous(C const& c) : contiguous{std::data(c), std::size(c)} {}
+  T const* data () const { return data_; }
+  size_t   size () const { return size_; }
+  T const* begin() const { return data_; }
+  T const* end  () const { return data_ + size_; }
+  T const& operator[](size_t i) const { return data_[i]; }
+private:
+  T const* data_;
+  size_t   size_;
+};
+
 template<class DATA>
 struct write_buffered {
 
@@ -149,6 +231,21 @@ struct write_buffered {
     if (buffer.size() >= buffer_size) { flush(); }
   }
 
+  // Bulk: one copy of all the records into the staging buffer
+  void append(contiguous<DATA> data) {
+    buffer.insert(buffer.end(), data.begin(), data.end());
+    if (buffer.size() >= buffer_size) { flush(); }
+  }
+
+  // Bulk, from a generator: `make(i)` returns the i-th of `n` records, each
+  // written once, straight into the staging buffer
+  template<class F>
+  void append(size_t n, F make) {
+    if (buffer.size() + n > buffer_size) { flush(); }
+    for (size_t i=0; i<n; ++i) { buffer.push_back(make(i)); }
+    if (buffer.size() >= buffer_size) { flush(); }
+  }
+
 private:
   HighFive::File      file;
   std::string   group_name;
@@ -165,6 +262,7 @@ private:
     auto old_size = dataset.getDimensions()[0];
     dataset.resize({old_size +  n_buffered_elements});
     dataset.select({old_size}, {n_buffered_elements}).write(buffer);
+    hdf5_written::add(n_buffered_elements, sizeof(DATA));
     buffer.clear(); // C++ standard guarantees capacity to be unchanged
   }
 
@@ -185,20 +283,36 @@ public:
   void write_run_info(const char* param_key, const char* param_value);
   void write_hit_info    (u32 evt_id, f16 x, f16 y, f16 z, f16 t);
   void write_primary     (u32 evt_id, f16 x, f16 y, f16 z, f16 vx, f16 vy, f16 vz);
-  void write_waveform    (u32 evt_id, u32 sensor_id, const std::vector<f16>& times);
+  void write_waveform    (u32 evt_id, u32 sensor_id, contiguous<f16> times);
   void write_total_charge(u32 evt_id, u32 sensor_id, u32 charge);
   void write_sensor_xyz              (u32 sensor_id, f16 x, f16 y, f16 z);
+  void write_weight      (u32 evt_id, f32 weight);
+  void write_event_cost  (event_cost_t const&);
+  void write_step_profile(std::string const& volume, std::string const& process, std::string const& particle,
+                          u64 steps, u64 timeable, u64 sampled, f64 seconds);
   void write_vertex(u32 evt_id, u32 track_id, u32 parent_id,
                     f16 x, f16 y, f16 z, f16 t,
                     f16 moved,
                     f16 pre_KE, f16 post_KE, f16 deposited,
                     u32 process_id, u32 volume_id);
+  // Many vertices at once: see write_buffered
+  void append(contiguous<vertex_t> vertices) { buf_vertex.append(vertices); }
 
   void write_strings(const std::string& dataset_name, const std::vector<std::string>& data);
 
+  // Written in one go, in its own group, only by jobs generating light maps
+  void write_light_map(light_map_binning_t const&,
+                       std::vector<light_map_voxel_t   > const&,
+                       std::vector<light_map_response_t> const&);
+
   // NOTE Only used in one test, so far
   static std::vector<hit_t> read_hit_info(std::string const& file_name);
 
+  using light_map_tables = std::tuple<light_map_binning_t,
+                                      std::vector<light_map_voxel_t>,
+                                      std::vector<light_map_response_t>>;
+  static light_map_tables read_light_map(std::string const& file_name);
+
 private:
   HighFive::File ensure_open_for_writing(std::string const& file_name);
 
@@ -212,6 +326,10 @@ public:
   write_buffered<  sensor_xyz_t> buf_sensors {file, "MC", "sensor_xyz"  , create_sensor_xyz_type  ()};
   write_buffered<   primaries_t> buf_primary {file, "MC", "primaries"   , create_primaries_type   ()};
   write_buffered<      vertex_t> buf_vertex  {file, "MC", "vertices"    , create_vertex_type      ()};
+  write_buffered<      weight_t> buf_weight  {file, "MC", "weights"     , create_weight_type      ()};
+  // Optional tables: only in the files of jobs which write them, from the first row
+  std::optional<write_buffered<event_cost_t>> buf_cost;
+  std::optional<write_buffered<step_profile_t>> buf_profile;
 };
 
 template<class T>
@@ -225,6 +343,7 @@ void hdf5_io::write(std::string const& dataset_name, T const& data) {
   auto index = dataset.getDimensions()[0];
   dataset.resize({index + n_elements});
   dataset.select({index}, {n_elements}).write(data);
+  hdf5_written::add(n_elements, sizeof(typename T::value_type));
 }
 
 #endif
@@ -0,0 +1,52 @@
+#include "io/job_metrics.hh"
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+TEST_CASE("job metrics file", "[job_metrics]") {
+  std::string file = std::tmpnam(nullptr);
+  job_metrics metrics;
+  metrics.start_run(100);
+  for (auto i=0; i<42; ++i) { job_metrics::bump(metrics.events); }
+  job_metrics::bump(metrics.steps, 1000);
+  job_metrics::bump(metrics.optical_detected, 7);
+
+  SECTION("published when the job ends") {
+    metrics.init_seconds = 1.5;
+    metrics.end_run();
+    { metrics_publisher publisher{metrics, file, 3600, {}}; }
+    auto stats = metrics_publisher::read(file);
+    CHECK(stats.version          == job_stats_t::current_version);
+    CHECK(stats.pid              == static_cast<uint64_t>(getpid()));
+    CHECK(stats.events           ==   42);
+    CHECK(stats.events_requested ==  100);
+    CHECK(stats.steps            == 1000);
+    CHECK(stats.optical_detected ==    7);
+    CHECK(stats.optical_tracked  ==    0);
+    CHECK(stats.rss_bytes        >     0);
+    CHECK(stats.steps_per_second >     0);
+    CHECK(stats.init_seconds     ==  1.5);
+    CHECK(stats.run_seconds      >=    0);
+    CHECK(stats.run_seconds      <     1); // Stopped at end_run, not at publication
+  }
+
+  SECTION("reported on request, outside the signal handler") {
+    std::atomic<uint64_t> reported{0};
+    metrics_publisher publisher{metrics, "", 3600, [&](auto const& stats) { reported = stats.events; }};
+    auto previous = std::signal(SIGUSR1, metrics_publisher::request_report);
+    std::raise(SIGUSR1);
+    for (auto i=0; i<50 && ! reported; ++i) { std::this_thread::sleep_for(std::chrono::milliseconds(20)); }
+    std::signal(SIGUSR1, previous);
+    CHECK(reported == 42);
+  }
+
+  std::remove(file.c_str());
+}
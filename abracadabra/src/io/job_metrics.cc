@@ -0,0 +1,138 @@
+#include "io/job_metrics.hh"
+
+#include "io/hdf5.hh"
+
+#include <cstdio>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+using std::chrono::steady_clock;
+
+struct metrics_publisher::file_layout {
+  std::atomic<uint64_t> sequence;
+  job_stats_t           stats;
+};
+
+namespace {
+std::atomic<bool> report_requested{false};
+static_assert(std::atomic<bool>::is_always_lock_free, "SIGUSR1 handler must be async-signal-safe");
+
+// Current resident set size, falling back to its peak
+uint64_t rss_bytes() {
+  std::ifstream statm{"/proc/self/statm"};
+  uint64_t pages_total, pages_resident;
+  if (statm >> pages_total >> pages_resident) { return pages_resident * sysconf(_SC_PAGESIZE); }
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss * 1024; // ru_maxrss is in kB
+}
+}
+
+void metrics_publisher::request_report(int) { report_requested.store(true, std::memory_order_relaxed); }
+
+metrics_publisher::metrics_publisher(job_metrics const& metrics, std::string const& file, double interval_seconds,
+                                     std::function<void(job_stats_t const&)> report)
+  : metrics{metrics}
+  , report{report}
+  , interval{interval_seconds}
+  , start{steady_clock::now()}
+  , last{start}
+{
+  if (! file.empty()) {
+    auto fd = open(file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, sizeof(file_layout)) != 0) {
+      throw std::runtime_error{"Cannot create metrics file " + file};
+    }
+    auto memory = mmap(nullptr, sizeof(file_layout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); // The mapping keeps the file open
+    if (memory == MAP_FAILED) { throw std::runtime_error{"Cannot map metrics file " + file}; }
+    mapped = new (memory) file_layout{};
+  }
+  publisher = std::thread{[this] { run(); }};
+}
+
+metrics_publisher::~metrics_publisher() {
+  stopping = true;
+  publisher.join();
+  publish(false);
+  if (mapped) { munmap(mapped, sizeof(file_layout)); }
+}
+
+// Short sleeps, so that signals are reported promptly
+void metrics_publisher::run() {
+  while (! stopping) {
+    std::this_thread::sleep_for(100ms);
+    auto requested = report_requested.exchange(false, std::memory_order_relaxed);
+    if (requested || steady_clock::now() - last >= interval) { publish(requested); }
+  }
+}
+
+void metrics_publisher::publish(bool report_now) {
+  auto now = steady_clock::now();
+  auto load = [](auto const& counter) { return counter.load(std::memory_order_relaxed); };
+
+  job_stats_t s{};
+  s.version           = job_stats_t::current_version;
+  s.pid               = getpid();
+  s.seconds           = std::chrono::duration<double>(now - start).count();
+  auto run_stop       = load(metrics.run_stop);
+  auto run_end        = run_stop ? steady_clock::duration{run_stop} : now.time_since_epoch();
+  s.run_seconds       = std::chrono::duration<double>(run_end - steady_clock::duration{load(metrics.run_start)}).count();
+  s.init_seconds      = load(metrics.init_seconds);
+  s.events            = load(metrics.events);
+  s.events_requested  = load(metrics.events_requested);
+  s.steps             = load(metrics.steps);
+  s.optical_tracked   = load(metrics.optical_tracked);
+  s.optical_detected  = load(metrics.optical_detected);
+  s.secondaries_yes   = load(metrics.secondaries_yes);
+  s.secondaries_no    = load(metrics.secondaries_no);
+  s.hdf5_rows         = load(hdf5_written::rows);
+  s.hdf5_bytes        = load(hdf5_written::bytes);
+  s.rss_bytes         = rss_bytes();
+
+  // Counters restart with each run
+  auto since_last = std::chrono::duration<double>(now - last).count();
+  auto rate = [&](auto count, auto last_count) {
+    return count >= last_count && since_last > 0 ? (count - last_count) / since_last : 0.0;
+  };
+  s.events_per_second = rate(s.events, last_events);
+  s.steps_per_second  = rate(s.steps , last_steps );
+  last = now; last_events = s.events; last_steps = s.steps;
+
+  if (mapped) {
+    auto sequence = mapped -> sequence.load(std::memory_order_relaxed);
+    mapped -> sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    mapped -> stats = s;
+    mapped -> sequence.store(sequence + 2, std::memory_order_release);
+  }
+  if (report_now && report) { report(s); }
+}
+
+job_stats_t metrics_publisher::read(std::string const& file) {
+  auto fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0) { throw std::runtime_error{"Cannot open metrics file " + file}; }
+  auto memory = mmap(nullptr, sizeof(file_layout), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) { throw std::runtime_error{"Cannot map metrics file " + file}; }
+  auto layout = static_cast<file_layout const*>(memory);
+
+  job_stats_t s;
+  uint64_t before, after;
+  do {
+    before = layout -> sequence.load(std::memory_order_acquire);
+    s = layout -> stats;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after  = layout -> sequence.load(std::memory_order_relaxed);
+  } while (before % 2 || before != after);
+
+  munmap(memory, sizeof(file_layout));
+  return s;
+}
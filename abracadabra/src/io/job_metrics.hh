@@ -0,0 +1,91 @@
+#ifndef io_job_metrics_hh
+#define io_job_metrics_hh
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+// Live throughput of a running job, for watching many concurrent jobs.
+//
+// The simulation thread updates the counters in `job_metrics`; a background
+// thread (`metrics_publisher`) periodically copies them, together with rates,
+// HDF5 output totals and memory use, into a small memory-mapped file
+// (`job_stats_t`), which an aggregator can read without disturbing the job.
+
+// Each counter has a single writer, so bump() needs no atomic read-modify-write
+struct job_metrics {
+  using counter = std::atomic<uint64_t>;
+  counter events{0}, events_requested{0};
+  counter steps{0};
+  counter optical_tracked{0}, optical_detected{0};
+  counter secondaries_yes{0}, secondaries_no{0};
+  std::atomic<std::chrono::steady_clock::rep> run_start{0}, run_stop{0}; // steady_clock ticks
+  std::atomic<double> init_seconds{0}; // Program start to first run: geometry, physics tables
+
+  void start_run(uint64_t n_events) {
+    events.store(0, std::memory_order_relaxed);
+    steps .store(0, std::memory_order_relaxed);
+    events_requested.store(n_events, std::memory_order_relaxed);
+    run_start.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    run_stop .store(0, std::memory_order_relaxed);
+  }
+  void end_run() {
+    run_stop.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+  }
+
+  static void bump(counter& c, uint64_t n = 1) {
+    c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  }
+};
+
+// Contents of the stats file, after a sequence number which is odd while the
+// publisher is writing: use metrics_publisher::read
+struct job_stats_t {
+  static constexpr uint64_t current_version = 2;
+  uint64_t version;
+  uint64_t pid;
+  double   seconds;             // Since the publisher started
+  double   run_seconds;         // Of the current, or last, run
+  double   init_seconds;
+  double   events_per_second;   // Since the previous publication
+  double   steps_per_second;    // Since the previous publication
+  uint64_t events, events_requested, steps;
+  uint64_t optical_tracked, optical_detected;
+  uint64_t secondaries_yes, secondaries_no;
+  uint64_t hdf5_rows, hdf5_bytes;
+  uint64_t rss_bytes;
+};
+
+class metrics_publisher {
+public:
+  // An empty `file` publishes nothing, but signals are still reported
+  metrics_publisher(job_metrics const&, std::string const& file, double interval_seconds,
+                    std::function<void(job_stats_t const&)> report);
+  ~metrics_publisher(); // Publishes one last time
+
+  // SIGUSR1 handler: only sets a flag, the publisher thread does the rest
+  static void request_report(int signal);
+
+  // Consistent snapshot of a stats file written by any job
+  static job_stats_t read(std::string const& file);
+
+private:
+  void run();
+  void publish(bool report);
+
+  struct file_layout;
+
+  job_metrics const& metrics;
+  std::function<void(job_stats_t const&)> report;
+  std::chrono::duration<double> interval;
+  file_layout* mapped = nullptr;
+  std::chrono::steady_clock::time_point start, last;
+  uint64_t last_events = 0, last_steps = 0;
+  std::atomic<bool> stopping{false};
+  std::thread publisher;
+};
+
+#endif
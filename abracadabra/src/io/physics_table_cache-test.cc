@@ -0,0 +1,57 @@
+// clang-format off
+
+#include "nain4.hh"
+
+#include "io/physics_table_cache.hh"
+
+#include <FTFP_BERT.hh>
+#include <G4EmStandardPhysics_option4.hh>
+#include <G4SystemOfUnits.hh>
+
+#include <catch2/catch.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <unistd.h>
+
+TEST_CASE("physics table cache key", "[physics_table_cache]") {
+  auto physics_list = new FTFP_BERT{0};
+  auto key = physics_table_key(physics_list);
+  CHECK(key == physics_table_key(physics_list));
+  CHECK(physics_table_directory("cache", key) == physics_table_directory("cache", key));
+
+  SECTION("depends on the physics") {
+    physics_list -> ReplacePhysics(new G4EmStandardPhysics_option4());
+    CHECK(physics_table_key(physics_list) != key);
+  }
+  SECTION("depends on the cuts") {
+    physics_list -> SetDefaultCutValue(physics_list -> GetDefaultCutValue() * 2);
+    CHECK(physics_table_key(physics_list) != key);
+  }
+  SECTION("depends on the materials") {
+    // Materials are global: a fresh name each time, so no other test sees a clash
+    static auto count = 0;
+    auto name = "physics_table_cache_test_" + std::to_string(count++);
+    nain4::material_from_elements_N(name, 1*g/cm3, kStateSolid, {{"H", 2}, {"O", 1}});
+    CHECK(physics_table_key(physics_list) != key);
+  }
+  delete physics_list;
+}
+
+TEST_CASE("physics table cache stale temporaries", "[physics_table_cache]") {
+  namespace fs = std::filesystem;
+  fs::path cache = std::tmpnam(nullptr);
+  auto complete = cache / "physics-complete";
+  auto stale    = cache / "physics-stale.tmp-999999999"; // Beyond any pid_max
+  auto live     = cache / ("physics-live.tmp-" + std::to_string(getpid()));
+  for (auto& dir : {complete, stale, live}) { fs::create_directories(dir); }
+
+  remove_stale_physics_tables(cache.string());
+  CHECK(  fs::exists(complete));
+  CHECK(! fs::exists(stale));
+  CHECK(  fs::exists(live));
+
+  remove_stale_physics_tables((cache / "missing").string()); // No cache yet: nothing to do
+  fs::remove_all(cache);
+}
@@ -0,0 +1,78 @@
+#include "io/physics_table_cache.hh"
+
+#include "nain4.hh"
+#include "utils/stable_hash.hh"
+
+#include <G4Material.hh>
+#include <G4ProductionCuts.hh>
+#include <G4RegionStore.hh>
+#include <G4VPhysicsConstructor.hh>
+#include <G4Version.hh>
+
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <sstream>
+#include <system_error>
+#include <signal.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+std::string physics_table_key(G4VModularPhysicsList const* physics_list) {
+  std::ostringstream key;
+  key << std::hexfloat << "Geant4 " << G4VERSION_NUMBER << '\n';
+
+  for (G4int i=0; physics_list -> GetPhysics(i); ++i) {
+    key << "physics " << physics_list -> GetPhysics(i) -> GetPhysicsName() << '\n';
+  }
+  key << "cut " << physics_list -> GetDefaultCutValue() << '\n';
+
+  for (auto region : *G4RegionStore::GetInstance()) {
+    key << "region " << region -> GetName();
+    if (auto cuts = region -> GetProductionCuts()) {
+      for (auto cut : cuts -> GetProductionCuts()) { key << ' ' << cut; }
+    }
+    key << '\n';
+  }
+
+  for (auto material : *G4Material::GetMaterialTable()) {
+    key << "material " << material -> GetName() << ' ' << material -> GetDensity();
+    auto fractions = material -> GetFractionVector();
+    for (size_t e=0; e<material -> GetNumberOfElements(); ++e) {
+      key << ' ' << material -> GetElement(e) -> GetName() << ' ' << fractions[e];
+    }
+    key << '\n';
+  }
+  return key.str();
+}
+
+std::string physics_table_directory(std::string const& cache, std::string const& key) {
+  return (fs::path{cache} / ("physics-" + stable_hash_hex(key))).string();
+}
+
+void remove_stale_physics_tables(std::string const& cache) {
+  std::error_code no_cache;
+  for (auto& entry : fs::directory_iterator{cache, no_cache}) {
+    auto name = entry.path().filename().string();
+    auto tmp  = name.rfind(".tmp-");
+    if (tmp == std::string::npos || ! entry.is_directory()) { continue; }
+    auto pid = std::strtol(name.c_str() + tmp + 5, nullptr, 10);
+    auto running = pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+    if (! running) { fs::remove_all(entry.path(), no_cache); }
+  }
+}
+
+bool physics_tables_stored(std::string const& directory) { return fs::is_directory(directory); }
+
+void store_physics_tables(G4VModularPhysicsList* physics_list, std::string const& directory) {
+  auto tmp = directory + ".tmp-" + std::to_string(getpid());
+  fs::create_directories(tmp);
+  if (! physics_list -> StorePhysicsTable(tmp)) {
+    fs::remove_all(tmp);
+    FATAL(("Failed to store physics tables in " + tmp).c_str());
+  }
+  std::error_code lost_race;
+  fs::rename(tmp, directory, lost_race);
+  if (lost_race) { fs::remove_all(tmp); }
+}
@@ -0,0 +1,32 @@
+#ifndef io_physics_table_cache_hh
+#define io_physics_table_cache_hh
+
+#include <G4VModularPhysicsList.hh>
+
+#include <string>
+
+// Physics tables stored by one job and retrieved by later ones, using Geant4's
+// own G4VUserPhysicsList::StorePhysicsTable / SetPhysicsTableRetrieved.
+//
+// Each set of tables lives in a subdirectory of the cache, named after a hash
+// of everything they depend on: the materials and regions (so must be called
+// once the geometry exists), the physics constructors, the production cuts and
+// the Geant4 version. Processes which do not support retrieval (hadronic,
+// optical) still build their tables as usual.
+
+std::string physics_table_key(G4VModularPhysicsList const*);
+std::string physics_table_directory(std::string const& cache, std::string const& key);
+
+// Removes the temporary directories left in `cache` by stores which were
+// interrupted (their job is no longer running). Call before using the cache.
+void remove_stale_physics_tables(std::string const& cache);
+
+// Tables only appear in `directory` once complete
+bool physics_tables_stored(std::string const& directory);
+
+// Tables must already have been built (e.g. at the start of a run). Written to
+// a temporary directory which is then renamed, so concurrent jobs never see a
+// partial set; if another job got there first, its tables are kept.
+void store_physics_tables(G4VModularPhysicsList*, std::string const& directory);
+
+#endif
@@ -2,6 +2,9 @@
 
 #include <catch2/catch.hpp>
 
+#include <cstdio>
+#include <string>
+
 TEST_CASE("raw_image roundtrip", "[io][raw_image]") {
   std::vector<float> pixels{1,2,3,4,5,6};
   raw_image original{{1,2,3}, {10,20,30}, pixels};
@@ -23,3 +26,15 @@ TEST_CASE("raw_image roundtrip", "[io][raw_image]") {
 
   CHECK(pixels == retrieved.data());
 }
+
+// Hidden: run explicitly with `[micro]` or `[benchmark]`
+TEST_CASE("raw_image throughput", "[.benchmark][micro][raw_image]") {
+  // The size of a typical density map
+  raw_image image{{180, 180, 180}, {360, 360, 360}};
+  std::string test_file_name = std::tmpnam(nullptr) + std::string("-test.raw");
+  image.write(test_file_name);
+
+  BENCHMARK("write") { image.write(test_file_name); };
+  BENCHMARK("read" ) { return raw_image{test_file_name}.data().size(); };
+  std::remove(test_file_name.c_str());
+}
@@ -4,6 +4,9 @@
 
 #include <G4Material.hh>
 #include <G4SystemOfUnits.hh>
+#include <Randomize.hh>
+
+#include <tuple>
 
 
 const G4double OPTPHOT_MIN_E = 1    * eV;
@@ -118,18 +121,29 @@ G4MaterialPropertiesTable* LXe_optical_material_properties() {
     .done();
 }
 
-G4double LXe_Scintillation(G4double energy) {
-  using CLHEP::c_light;   using CLHEP::h_Planck;   using CLHEP::pi;
-  // K. Fuji et al., "High accuracy measurement of the emission spectrum of liquid xenon
-  // in the vacuum ultraviolet region",
-  // Nuclear Instruments and Methods in Physics Research A 795 (2015) 293–297
-  // http://ac.els-cdn.com/S016890021500724X/1-s2.0-S016890021500724X-main.pdf?_tid=83d56f0a-3aff-11e7-bf7d-00000aacb361&acdnat=1495025656_407067006589f99ae136ef18b8b35a04
+// K. Fuji et al., "High accuracy measurement of the emission spectrum of liquid xenon
+// in the vacuum ultraviolet region",
+// Nuclear Instruments and Methods in Physics Research A 795 (2015) 293–297
+// http://ac.els-cdn.com/S016890021500724X/1-s2.0-S016890021500724X-main.pdf?_tid=83d56f0a-3aff-11e7-bf7d-00000aacb361&acdnat=1495025656_407067006589f99ae136ef18b8b35a04
+std::tuple<G4double, G4double> LXe_scintillation_peak_and_sigma() {
+  using CLHEP::c_light;   using CLHEP::h_Planck;
   G4double lambda_peak  = 174.8 * nm;
   G4double lambda_FWHM  =  10.2 * nm;
   G4double lambda_sigma = lambda_FWHM / 2.35;
 
   G4double E_peak  = (h_Planck * c_light / lambda_peak);
   G4double E_sigma = (h_Planck * c_light * lambda_sigma / pow(lambda_peak, 2));
+  return {E_peak, E_sigma};
+}
+
+G4double LXe_random_scintillation_energy() {
+  auto [E_peak, E_sigma] = LXe_scintillation_peak_and_sigma();
+  return G4RandGauss::shoot(E_peak, E_sigma);
+}
+
+G4double LXe_Scintillation(G4double energy) {
+  using CLHEP::pi;
+  auto [E_peak, E_sigma] = LXe_scintillation_peak_and_sigma();
 
   G4double intensity = exp(-pow(E_peak / eV - energy / eV, 2) / (2 * pow(E_sigma / eV, 2)))
     / (E_sigma / eV * sqrt(pi * 2.));
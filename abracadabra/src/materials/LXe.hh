@@ -7,6 +7,7 @@
 G4double LXe_refractive_index(G4double energy);
 G4MaterialPropertiesTable* LXe_optical_material_properties();
 G4double LXe_Scintillation(G4double energy);
+G4double LXe_random_scintillation_energy(); // Sampled from LXe_Scintillation
 
 G4Material*    LXe_with_properties();
 G4Material* G4_LXe_with_properties();
@@ -8,6 +8,7 @@ abracadabra_messenger::abracadabra_messenger()
   messenger -> DeclareProperty("geometry"  , geometry  , "Geometry to be instantiated");
   messenger -> DeclareProperty("detector"  , detector  , "Detector to be instantiated");
   messenger -> DeclareProperty("phantom"   , phantom   , "Phantom to be used");
+  messenger -> DeclareProperty("physics"   , physics   , "Physics list: FTFP_BERT, lean_pet or lean_pet_no_optical");
   messenger -> DeclareProperty("spin_view" , spin      , "Spin geometry view");
   messenger -> DeclareProperty("spin_speed", spin_speed, "Spin geometry speed");
   messenger -> DeclareProperty("verbosity" , verbosity , "Print live event information");
@@ -19,8 +20,30 @@ abracadabra_messenger::abracadabra_messenger()
   messenger -> DeclareProperty("cylinder_length" , cylinder_length,  "Length of cylinder");
   messenger -> DeclareProperty("cylinder_radius" , cylinder_radius,  "Radius of cylinder");
   messenger -> DeclareProperty("E_cut"           , E_cut          ,  "Abort and ignore event if gamma E drops below threshold, before LXe");
+  messenger -> DeclareProperty("cut_phantom"     , cut_phantom     ,  "Production cut (mm) in the phantom, 0 for default");
+  messenger -> DeclareProperty("cut_passive"     , cut_passive     ,  "Production cut (mm) in the steel layers, 0 for default");
+  messenger -> DeclareProperty("cut_scintillator", cut_scintillator,  "Production cut (mm) in the scintillator, 0 for default");
+  messenger -> DeclareProperty("E_min_gamma"     , E_min_gamma    ,  "Ignore secondaries unless each gamma loses at least this energy (keV) in scintillator");
+  messenger -> DeclareProperty("E_min_total"     , E_min_total    ,  "Ignore secondaries unless gammas lose at least this energy (keV) in scintillator, in total");
+  messenger -> DeclareProperty("acceptance_filter", acceptance_filter,  "Only generate gamma pairs which reach the scintillator; weight events by acceptance");
+  messenger -> DeclareProperty("acquisition_window", acquisition_window,  "Ignore photons arriving this long (ns) after the first sensor hit");
+  messenger -> DeclareProperty("kill_late_photons" , kill_late_photons ,  "Stop tracking optical photons as soon as they fall outside acquisition_window");
+  messenger -> DeclareProperty("pde_at_creation" , pde_at_creation,  "Apply SiPM PDE in the simulation, thinning optical photons at creation");
+  messenger -> DeclareProperty("light_map"        , light_map        ,  "Files (glob) of light map to use instead of tracking scintillation photons");
+  messenger -> DeclareProperty("light_map_bins"   , light_map_bins   ,  "Number of r, phi, z bins of light maps being generated");
+  messenger -> DeclareProperty("light_map_photons", light_map_photons,  "Optical photons emitted per event, when generating light maps");
   messenger -> DeclareProperty("steel_is_vacuum" , steel_is_vacuum,  "Replace steel with vacuum in IMAS");
+  messenger -> DeclareProperty("replicated_sipms", replicated_sipms,  "Build IMAS SiPM ring from replicas rather than individual placements");
+  messenger -> DeclareProperty("flat_layers"     , flat_layers    ,  "Detector layers as sibling annular shells, rather than nested cylinders");
+  messenger -> DeclareProperty("geometry_cache"  , geometry_cache ,  "Directory in which to save/load the geometry (GDML), keyed by its parameters");
+  messenger -> DeclareProperty("physics_table_cache", physics_table_cache, "Directory in which to store/retrieve physics tables, keyed by materials and physics");
+  messenger -> DeclareProperty("metrics_file"    , metrics_file    ,  "File to which live job metrics are published (memory-mapped, see io/job_metrics.hh)");
+  messenger -> DeclareProperty("metrics_interval", metrics_interval,  "Seconds between publications of live job metrics");
+  messenger -> DeclareProperty("event_cost"      , event_cost      ,  "Write wall time, tracks and steps of each event to MC/event_cost");
+  messenger -> DeclareProperty("slowest_events"  , slowest_events  ,  "With event_cost, save random engine state of this many slowest events per run");
+  messenger -> DeclareProperty("step_profile"    , step_profile    ,  "Profile steps per volume, process and particle, timing every Nth step (0: off)");
   messenger -> DeclareProperty("vacuum_phantom"  , vacuum_phantom ,  "Set all phantom materials to vacuum");
+  messenger -> DeclareProperty("extruded_nema_7" , extruded_nema_7,  "Faster NEMA7 body solid: extruded polygon rather than union");
   messenger -> DeclareProperty("magic_level"     , magic_level ,     "1: suppress secondaries; "
                                                                      "2: detect all gammas on entry into LXe; "
                                                                      "3: LXe-only IMAS-like detector");
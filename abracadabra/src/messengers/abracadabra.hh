@@ -2,6 +2,7 @@
 #define messengers_abracadabra_hh
 
 #include <G4GenericMessenger.hh>
+#include <G4ThreeVector.hh>
 
 #include <memory>
 
@@ -12,6 +13,7 @@ struct abracadabra_messenger {
   G4String geometry   = "both";
   G4String detector   = "imas";
   G4String phantom    = "nema_7";
+  G4String physics    = "FTFP_BERT";
   bool     spin       = true;
   G4int    spin_speed = 10;
   G4int    verbosity  = 1;
@@ -23,8 +25,30 @@ struct abracadabra_messenger {
   G4double cylinder_length         =  15; // mm
   G4double cylinder_radius         = 200; // mm
   G4double E_cut = 0; // keV
+  G4double cut_phantom      = 0; // mm, 0: physics list default
+  G4double cut_passive      = 0; // mm, 0: physics list default
+  G4double cut_scintillator = 0; // mm, 0: physics list default
+  G4double E_min_gamma = 0; // keV
+  G4double E_min_total = 0; // keV
+  bool acceptance_filter = false;
+  G4double acquisition_window = 500; // ns
+  bool kill_late_photons = false;
+  bool pde_at_creation   = false;
+  G4String      light_map         = ""; // glob pattern of light map files
+  G4ThreeVector light_map_bins    = {5, 72, 60}; // r, phi, z
+  G4int         light_map_photons = 100000;
   bool steel_is_vacuum = false;
+  bool replicated_sipms = false;
+  bool flat_layers      = false;
+  G4String geometry_cache = ""; // directory of GDML snapshots
+  G4String physics_table_cache = ""; // directory of stored physics tables
+  G4String metrics_file     = ""; // memory-mapped live job metrics
+  G4double metrics_interval = 10; // s
+  bool   event_cost     = false;
+  size_t slowest_events = 0; // save random engine state of this many, with event_cost
+  size_t step_profile   = 0; // time every Nth step, 0: no stepping profiler
   bool vacuum_phantom  = false;
+  bool extruded_nema_7 = false;
   size_t magic_level = 0;
   size_t nema5_sleeves = 1;
   G4double jaszczak_activity_sphere = 4.0;
@@ -3,6 +3,10 @@
 #include <CLHEP/Units/SystemOfUnits.h>
 #include <catch2/catch.hpp>
 
+#include <cstdio>
+#include <string>
+#include <vector>
+
 
 TEST_CASE("biased choice", "[random][biased][choice]") {
 
@@ -83,3 +87,32 @@ TEST_CASE("random point in sphere", "[random][sphere]") {
   check_around_axis(z_hits);
 
 }
+
+TEST_CASE("random engine state", "[random][engine]") {
+  auto file = std::string{std::tmpnam(nullptr)} + ".rndm";
+  auto state = current_engine_state();
+  std::vector<G4double> first, replayed;
+  for (auto i=0; i<10; ++i) { first.push_back(uniform()); }
+
+  // Saving does not disturb the current sequence
+  save_engine_state(state, file);
+  auto next = uniform();
+  G4Random::getTheEngine() -> get(state);
+  for (auto i=0; i<10; ++i) { uniform(); }
+  CHECK(uniform() == next);
+
+  G4Random::restoreEngineStatus(file.c_str());
+  for (auto i=0; i<10; ++i) { replayed.push_back(uniform()); }
+  CHECK(replayed == first);
+  std::remove(file.c_str());
+}
+
+// Hidden: run explicitly with `[micro]` or `[benchmark]`
+TEST_CASE("random generation throughput", "[.benchmark][micro][random]") {
+  // Relative activities of the NEMA 7 regions: body, lung and six spheres
+  auto pick = biased_choice({1, 0, 4, 4, 4, 4, 0, 0});
+
+  BENCHMARK("biased_choice")    { return pick(); };
+  BENCHMARK("random_in_sphere") { return random_in_sphere(10*CLHEP::mm); };
+  BENCHMARK("random_on_disc")   { return random_on_disc(100*CLHEP::mm); };
+}
@@ -68,3 +68,11 @@ unsigned biased_choice::operator()() const {
   auto n = fair_die(prob.size());
   return biased_coin(prob[n]) ? n : topup[n];
 }
+
+void save_engine_state(engine_state const& state, std::string const& file_name) {
+  auto engine = G4Random::getTheEngine();
+  auto current = engine -> put();
+  engine -> get(state);
+  engine -> saveStatus(file_name.c_str());
+  engine -> get(current);
+}
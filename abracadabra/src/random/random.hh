@@ -6,6 +6,7 @@
 
 #include <Randomize.hh>
 
+#include <string>
 #include <vector>
 
 // Random result generation utilities
@@ -25,6 +26,13 @@ private:
   std::vector<unsigned> topup;
 };
 
+// Full state of the Geant4 random engine, cheap to capture at the start of
+// every event. Saved in the format read by /random/resetEngineFrom, so that
+// an event can be replayed on its own; saving leaves the current state as it was.
+using engine_state = std::vector<unsigned long>;
+inline engine_state current_engine_state() { return G4Random::getTheEngine() -> put(); }
+void save_engine_state(engine_state const&, std::string const& file_name);
+
 G4ThreeVector random_in_sphere(G4double radius);
 std::tuple<G4double, G4double> random_on_disc(G4double radius);
 
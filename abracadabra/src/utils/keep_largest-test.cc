@@ -0,0 +1,25 @@
+#include "utils/keep_largest.hh"
+
+#include <catch2/catch.hpp>
+
+#include <string>
+
+TEST_CASE("keep largest", "[utils][keep_largest]") {
+  keep_largest<std::string> slowest{3};
+  for (auto [key, name] : {std::pair{2.0, "b"}, {9.0, "e"}, {1.0, "a"}, {5.0, "c"}, {7.0, "d"}}) {
+    slowest.offer(key, name);
+  }
+  CHECK(slowest.size() == 3);
+  CHECK(  slowest.would_keep(6.0));
+  CHECK(! slowest.would_keep(4.0));
+
+  auto sorted = slowest.sorted();
+  REQUIRE(sorted.size() == 3);
+  CHECK(sorted[0].second == "e");
+  CHECK(sorted[1].second == "d");
+  CHECK(sorted[2].second == "c");
+
+  keep_largest<int> none{0};
+  none.offer(1.0, 1);
+  CHECK(none.size() == 0);
+}
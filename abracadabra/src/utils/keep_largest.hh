@@ -0,0 +1,50 @@
+#ifndef utils_keep_largest_hh
+#define utils_keep_largest_hh
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// The `n` items with the largest keys offered so far, e.g. the slowest events
+// of a run. Check `would_keep` before building an expensive item.
+template<class T, class KEY = double>
+class keep_largest {
+public:
+  using entry = std::pair<KEY, T>;
+
+  explicit keep_largest(size_t n) : n{n} {}
+
+  bool would_keep(KEY const& key) const {
+    return n > 0 && (heap.size() < n || heap.front().first < key);
+  }
+
+  void offer(KEY const& key, T item) {
+    if (! would_keep(key)) { return; }
+    if (heap.size() == n) {
+      std::pop_heap(begin(heap), end(heap), smallest_first);
+      heap.pop_back();
+    }
+    heap.emplace_back(key, std::move(item));
+    std::push_heap(begin(heap), end(heap), smallest_first);
+  }
+
+  // Largest key first
+  std::vector<entry> sorted() const {
+    auto result = heap;
+    std::sort(begin(result), end(result), [](auto& a, auto& b) { return a.first > b.first; });
+    return result;
+  }
+
+  size_t size() const { return heap.size(); }
+  void clear() { heap.clear(); }
+
+private:
+  static bool smallest_first(entry const& a, entry const& b) { return a.first > b.first; }
+
+  size_t n;
+  std::vector<entry> heap; // Smallest key at the front
+};
+
+#endif
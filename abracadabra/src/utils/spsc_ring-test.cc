@@ -0,0 +1,39 @@
+#include "utils/spsc_ring.hh"
+
+#include <catch2/catch.hpp>
+
+#include <thread>
+
+TEST_CASE("spsc ring", "[utils][spsc_ring]") {
+  SECTION("bounded") {
+    spsc_ring<int> ring{5};
+    CHECK(ring.capacity() == 8);
+    CHECK(ring.empty());
+    for (int i=0; i<8; ++i) { CHECK(ring.try_push(i)); }
+    CHECK(! ring.try_push(8)); // Full
+    CHECK(! ring.empty());
+
+    int item;
+    for (int i=0; i<8; ++i) { REQUIRE(ring.try_pop(item)); CHECK(item == i); }
+    CHECK(! ring.try_pop(item)); // Empty
+    CHECK(ring.empty());
+
+    // Wraps around
+    for (int i=0; i<20; ++i) { CHECK(ring.try_push(i)); REQUIRE(ring.try_pop(item)); CHECK(item == i); }
+  }
+
+  SECTION("one producer, one consumer") {
+    spsc_ring<size_t> ring{64};
+    size_t const N = 1000000;
+    std::thread producer{[&] {
+      for (size_t i=0; i<N; ++i) { while (! ring.try_push(i)) { std::this_thread::yield(); } }
+    }};
+    size_t expected = 0, item, out_of_order = 0;
+    while (expected < N) {
+      if (ring.try_pop(item)) { out_of_order += item != expected; ++expected; }
+    }
+    producer.join();
+    CHECK(out_of_order == 0);
+    CHECK(! ring.try_pop(item));
+  }
+}
@@ -0,0 +1,52 @@
+#ifndef utils_spsc_ring_hh
+#define utils_spsc_ring_hh
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded, lock-free queue for exactly one producer thread and one consumer
+// thread. Neither side ever blocks: try_push fails when the ring is full,
+// try_pop when it is empty.
+template<class T>
+class spsc_ring {
+public:
+  // Capacity is rounded up to a power of two
+  explicit spsc_ring(size_t min_capacity) : slots(round_up(min_capacity)), mask{slots.size() - 1} {}
+
+  // Producer only
+  bool try_push(T const& item) {
+    auto h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) == slots.size()) { return false; }
+    slots[h & mask] = item;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only
+  bool try_pop(T& item) {
+    auto t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) { return false; }
+    item = slots[t & mask];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only: whether try_pop would fail
+  bool empty() const {
+    return tail.load(std::memory_order_relaxed) == head.load(std::memory_order_acquire);
+  }
+
+  size_t capacity() const { return slots.size(); }
+
+private:
+  static size_t round_up(size_t n) { size_t p = 1; while (p < n) { p <<= 1; } return p; }
+
+  std::vector<T> slots;
+  size_t         mask;
+  // On separate cache lines: each is written by only one of the threads
+  alignas(64) std::atomic<size_t> head{0}; // Next slot to write
+  alignas(64) std::atomic<size_t> tail{0}; // Next slot to read
+};
+
+#endif
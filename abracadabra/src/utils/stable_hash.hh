@@ -0,0 +1,23 @@
+#ifndef utils_stable_hash_hh
+#define utils_stable_hash_hh
+
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+// FNV-1a: unlike std::hash, stable across compilers and runs, so suitable for
+// naming files shared between jobs
+inline std::uint64_t stable_hash(std::string const& key) {
+  std::uint64_t hash = 14695981039346656037ull;
+  for (unsigned char c : key) { hash = (hash ^ c) * 1099511628211ull; }
+  return hash;
+}
+
+inline std::string stable_hash_hex(std::string const& key) {
+  std::ostringstream hex;
+  hex << std::hex << std::setw(16) << std::setfill('0') << stable_hash(key);
+  return hex.str();
+}
+
+#endif
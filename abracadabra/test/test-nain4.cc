@@ -1,4 +1,5 @@
 #include "nain4.hh"
+#include "g4-mandatory.hh"
 
 // Solids
 #include <G4Box.hh>
@@ -15,7 +16,14 @@
 
 // Other G4
 #include <G4Material.hh>
+#include <G4PVReplica.hh>
+#include <G4ProductionCuts.hh>
+#include <G4DynamicParticle.hh>
+#include <G4Electron.hh>
 #include <G4Gamma.hh>
+#include <G4NavigationHistory.hh>
+#include <G4TouchableHistory.hh>
+#include <G4Track.hh>
 
 #include <catch2/catch.hpp>
 
@@ -25,7 +33,16 @@
 // this gives rise to the apparently superfluous division by the same unit on
 // both sides of an equation, in the source code.
 
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <memory_resource>
 #include <numeric>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
 
 TEST_CASE("nain material", "[nain][material]") {
 
@@ -321,6 +338,27 @@ TEST_CASE("nain find", "[nain][find]") {
   }
 }
 
+TEST_CASE("nain region", "[nain][region]") {
+  auto air = nain4::material("G4_AIR");
+  auto one = nain4::volume<G4Box>("region test one", air, 1*cm, 1*cm, 1*cm);
+  auto two = nain4::volume<G4Box>("region test two", air, 1*cm, 1*cm, 1*cm);
+
+  // Created on first use, found thereafter
+  auto region = nain4::region("made just for region test").add(one).now();
+  CHECK(nain4::find_region("made just for region test") == region);
+  CHECK(nain4::region("made just for region test").add(two).now() == region);
+  CHECK(region -> GetNumberOfRootVolumes() == 2);
+  CHECK(region -> GetProductionCuts() == nullptr);
+
+  // Cuts for all particles, then for one of them
+  nain4::region("made just for region test").cut(3*mm).cut("gamma", 5*mm).now();
+  auto cuts = region -> GetProductionCuts();
+  REQUIRE(cuts);
+  CHECK(cuts -> GetProductionCut("gamma") / mm == 5);
+  CHECK(cuts -> GetProductionCut("e-")    / mm == 3);
+  CHECK(cuts -> GetProductionCut("e+")    / mm == 3);
+}
+
 TEST_CASE("nain clear_geometry", "[nain][clear_geometry]") {
   auto name = "vanish";
   auto air = nain4::material("G4_AIR");
@@ -374,3 +412,253 @@ TEST_CASE("nain geometry iterator", "[nain][geometry][iterator]") {
   CHECK(found == expected);
 
 }
+
+TEST_CASE("nain geometry catalogue", "[nain][geometry][catalogue]") {
+  auto air = nain4::material("G4_AIR");
+
+  auto l    = nain4::volume<G4Box>("cat l"   , air, 100*m, 100*m, 100*m);
+  auto l1   = nain4::volume<G4Box>("cat l1"  , air,  40*m,  40*m,  40*m);
+  auto l11  = nain4::volume<G4Box>("cat l11" , air,  10*m,  10*m,  10*m);
+  auto row  = nain4::volume<G4Box>("cat row" , air,  40*m,  10*m,  10*m);
+  auto cell = nain4::volume<G4Box>("cat cell", air,  10*m,  10*m,  10*m);
+
+  auto p   = nain4::place(l  )                           .now();
+  auto p1  = nain4::place(l1 ).in(l) .at(-50*m, 0*m, 0*m).now();
+  auto p11 = nain4::place(l11).in(l1).at(  0*m, 5*m, 0*m).copy_no(7).now();
+  nain4::place(row).in(l).at(50*m, 0*m, 0*m).now();
+  auto pc = new G4PVReplica("cat cell", cell, row, kXAxis, 4, 20*m);
+
+  nain4::geometry_catalogue catalogue{p};
+  REQUIRE(catalogue.size() == 1 + 2 + 1 + 4);
+
+  // Parents and global transforms
+  auto i11 = catalogue.find(l11, 7);
+  REQUIRE(i11);
+  auto& e11 = catalogue[*i11];
+  CHECK(e11.volume == p11);
+  CHECK(catalogue[e11.parent].volume == p1);
+  CHECK(catalogue[catalogue[e11.parent].parent].volume == p);
+  CHECK(catalogue[catalogue[e11.parent].parent].parent == nain4::geometry_catalogue::none);
+  CHECK(e11.position() == G4ThreeVector{-50*m, 5*m, 0*m});
+  CHECK(catalogue.name(e11.name_id) == "cat l11-7");
+
+  // Replicas are expanded into one entry per copy
+  auto& cells = catalogue.placements_of(cell);
+  REQUIRE(cells.size() == 4);
+  for (size_t n=0; n<cells.size(); ++n) {
+    auto& e = catalogue[cells[n]];
+    CHECK(e.volume  == pc);
+    CHECK(e.copy_no == static_cast<G4int>(n));
+    CHECK(e.position().x() / m == Approx(50 - 30 + 20 * n));
+  }
+  CHECK(catalogue.named("cat cell") == cells);
+
+  // Absent things
+  CHECK(catalogue.named("not in the catalogue").empty());
+  CHECK(catalogue.placements_of(nullptr).empty());
+  CHECK(! catalogue.find(l11, 0));
+}
+
+TEST_CASE("nain geometry iterator equality", "[nain][geometry][iterator]") {
+  auto air = nain4::material("G4_AIR");
+  auto l   = nain4::volume<G4Box>("eq l" , air, 10*m, 10*m, 10*m);
+  auto l1  = nain4::volume<G4Box>("eq l1", air,  1*m,  1*m,  1*m);
+  nain4::place(l1).in(l).at(-5*m, 0, 0).now();
+  nain4::place(l1).in(l).at( 5*m, 0, 0).now();
+  auto p = nain4::place(l).now();
+
+  auto a = begin(p), b = begin(p);
+  CHECK(a == b);
+  ++a;      CHECK(a != b);
+  ++b;      CHECK(a == b);
+  ++a; ++a; CHECK(a == end(p));
+  CHECK(b != end(p));
+}
+
+TEST_CASE("nain stepping actions", "[nain][stepping_action]") {
+  G4Step step;
+  std::vector<int> calls;
+
+  SECTION("callable stored by value") {
+    auto action = n4::stepping_action_t{[&](const G4Step* s) { CHECK(s == &step); calls.push_back(1); }};
+    G4UserSteppingAction& base = action;
+    base.UserSteppingAction(&step);
+    CHECK(calls == std::vector<int>{1});
+  }
+
+  SECTION("composed handlers are called in order") {
+    auto action = n4::stepping_action_t{n4::compose_steps([&](auto) { calls.push_back(1); },
+                                                          [&](auto) { calls.push_back(2); },
+                                                          [&](auto) { calls.push_back(3); })};
+    action.UserSteppingAction(&step);
+    action.UserSteppingAction(&step);
+    CHECK(calls == std::vector<int>{1, 2, 3, 1, 2, 3});
+  }
+}
+
+TEST_CASE("nain step profiler", "[nain][step_profiler]") {
+  auto water = nain4::material("G4_WATER");
+  auto box   = nain4::place(nain4::volume<G4Box>("profiled_box", water, 1*m, 1*m, 1*m)).now();
+  G4NavigationHistory history;
+  history.SetFirstEntry(box);
+
+  auto step_of = [&](auto particle) {
+    auto step  = new G4Step;
+    auto track = new G4Track{new G4DynamicParticle{particle, G4ThreeVector{0,0,1}, 1*MeV}, 0, {}};
+    step -> SetTrack(track);
+    step -> GetPreStepPoint() -> SetTouchableHandle(new G4TouchableHistory{history});
+    return std::unique_ptr<G4Step>{step};
+  };
+  auto gamma = step_of(G4Gamma::Definition()), electron = step_of(G4Electron::Definition());
+
+  n4::step_profiler profiler{10};
+  auto user_calls = 0;
+  auto action = n4::stepping_action_t{profiler.around([&](auto) { user_calls++; })};
+  auto step = [&](auto& s) {
+    s -> GetTrack() -> IncrementCurrentStepNumber();
+    action.UserSteppingAction(s.get());
+  };
+  for (auto i=0; i<1000; ++i) { step(gamma); }
+  for (auto i=0; i<  10; ++i) { step(electron); }
+
+  auto summary = profiler.summary();
+  REQUIRE(summary.size() == 2);
+  auto& g = summary[0].particle == "gamma" ? summary[0] : summary[1];
+  auto& e = summary[0].particle == "gamma" ? summary[1] : summary[0];
+  CHECK(g.volume  == "profiled_box");
+  CHECK(g.process == "None");
+  CHECK(user_calls == 1010);
+  CHECK(g.steps    == 1000);
+  CHECK(e.steps    ==   10);
+  // The first step of each track cannot be timed
+  CHECK(g.timeable ==  999);
+  CHECK(e.timeable ==    9);
+  // Every 10th step starts a timing, completed by the next step of the same
+  // track: the one started by the last gamma step ends in another track
+  CHECK(g.sampled  ==   99);
+  CHECK(e.sampled  ==    0);
+  CHECK(g.seconds() >= 0);
+
+  std::ostringstream out;
+  profiler.print(out);
+  CHECK(out.str().find("1010 steps") != std::string::npos);
+
+  profiler.clear();
+  CHECK(profiler.summary().empty());
+}
+
+TEST_CASE("nain step profiler excludes user actions", "[nain][step_profiler]") {
+  auto water = nain4::material("G4_WATER");
+  auto box   = nain4::place(nain4::volume<G4Box>("slow_box", water, 1*m, 1*m, 1*m)).now();
+  G4NavigationHistory history;
+  history.SetFirstEntry(box);
+  auto step  = std::make_unique<G4Step>();
+  auto track = new G4Track{new G4DynamicParticle{G4Gamma::Definition(), G4ThreeVector{0,0,1}, 1*MeV}, 0, {}};
+  step -> SetTrack(track);
+  step -> GetPreStepPoint() -> SetTouchableHandle(new G4TouchableHistory{history});
+
+  n4::step_profiler profiler{1};
+  auto slow   = [](auto) { std::this_thread::sleep_for(std::chrono::milliseconds{1}); };
+  auto action = n4::stepping_action_t{profiler.around(slow)};
+  for (auto i=0; i<50; ++i) {
+    track -> IncrementCurrentStepNumber();
+    action.UserSteppingAction(step.get());
+  }
+
+  auto summary = profiler.summary();
+  REQUIRE(summary.size() == 1);
+  CHECK(summary[0].sampled == 49);
+  // 49 ms if the user action were included
+  CHECK(summary[0].sampled_seconds < 0.01);
+}
+
+TEST_CASE("nain event arena", "[nain][event_arena]") {
+  n4::event_arena arena{1024};
+  auto one_event = [&] {
+    std::pmr::map<int, std::pmr::vector<double>> sensors{arena.resource()};
+    for (auto i=0; i<100; ++i) {
+      auto& times = sensors[i];
+      for (auto j=0; j<i; ++j) { times.push_back(j); }
+    }
+    CHECK(sensors.get_allocator().resource() == arena.resource());
+    CHECK(sensors[99].get_allocator().resource() == arena.resource()); // Propagated to the elements
+    CHECK(sensors[99].size() == 99);
+  };
+
+  one_event();
+  arena.reset();
+  auto grown = arena.capacity();
+  CHECK(grown > 1024); // Overflowed: the buffer grows to fit
+
+  // Events no larger than the largest so far fit in the buffer
+  for (auto i=0; i<10; ++i) {
+    one_event();
+    arena.reset();
+    CHECK(arena.capacity() == grown);
+  }
+}
+
+TEST_CASE("nain id store", "[nain][id_store]") {
+  n4::id_store names{"LXe", "compt", "phot", "Rayl"};
+  CHECK(names.id("LXe"  ) == 0);
+  CHECK(names.id("Rayl" ) == 3);
+  CHECK(names.id("msc"  ) == 4); // New
+  CHECK(names.id(std::string{"msc"}) == 4);
+  CHECK(names.id(G4String   {"LXe"}) == 0);
+
+  for (auto i=0u; i<1000; ++i) { CHECK(names.id("n" + std::to_string(i)) == 5 + i); }
+  for (auto i=0u; i<1000; ++i) { CHECK(names.id("n" + std::to_string(i)) == 5 + i); }
+
+  auto items = names.items_ordered_by_id();
+  REQUIRE(items.size() == 1005);
+  CHECK(std::vector<std::string>(items.begin(), items.begin() + 5) ==
+        std::vector<std::string>{"LXe", "compt", "phot", "Rayl", "msc"});
+
+  SECTION("by object") {
+    int a, b;
+    CHECK(names.id(&a, "phot") == 2);
+    CHECK(names.id(&b, "eIoni") == 1005); // New
+    CHECK(names.id(&a, "ignored") == 2);  // The name is only read the first time
+    CHECK(names.items_ordered_by_id().size() == 1006);
+    names.forget_objects();
+    CHECK(names.id(&a, "Rayl") == 3);
+  }
+}
+
+// Hidden: run explicitly with `[micro]` or `[benchmark]`
+TEST_CASE("nain id store lookup", "[.benchmark][micro][id_store]") {
+  // As used for the volume names of every recorded vertex
+  n4::id_store volume_names{
+    "LXe", "Cavity", "Steel_0", "Inner_vacuum", "Steel_1", "Quartz","Outer_vacuum", "Steel_2",
+    "Body", "Lung", "Source_0", "Source_1", "Source_2", "Source_3", "Source_4", "Source_5",
+    "Cylinder", "Line_source", "Source", "Sleeves"};
+  std::vector<G4String> queries{"LXe", "Steel_1", "Outer_vacuum", "Body", "Source_3", "LXe", "Quartz"};
+
+  BENCHMARK("by name") {
+    size_t total = 0;
+    for (auto& q : queries) { total += volume_names.id(q); }
+    return total;
+  };
+  BENCHMARK("by object") {
+    size_t total = 0;
+    for (auto& q : queries) { total += volume_names.id(&q, q); }
+    return total;
+  };
+}
+
+// Hidden: run explicitly with `[benchmark]`
+TEST_CASE("nain stepping action overhead", "[.benchmark][stepping_action]") {
+  G4Step step;
+
+  // Two handlers, as small as possible, so that only the dispatch is measured
+  size_t count = 0, sum = 0;
+  auto count_steps = [&](const G4Step*  ) { ++count; };
+  auto sum_steps   = [&](const G4Step* s) { sum += reinterpret_cast<std::uintptr_t>(s) & 1; };
+
+  auto both = [&](const G4Step* s) { count_steps(s); sum_steps(s); };
+  std::unique_ptr<G4UserSteppingAction> erased  {new n4::stepping_action{both}};
+  std::unique_ptr<G4UserSteppingAction> by_value{new n4::stepping_action_t{n4::compose_steps(count_steps, sum_steps)}};
+
+  BENCHMARK("std::function"     ) { erased   -> UserSteppingAction(&step); return count; };
+  BENCHMARK("stepping_action_t" ) { by_value -> UserSteppingAction(&step); return count; };
+}
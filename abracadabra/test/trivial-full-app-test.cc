@@ -1,12 +1,17 @@
 // clang-format off
 
 #include "nain4.hh"
+#include "g4-mandatory.hh"
+#include "random/random.hh"
+#include "utils/keep_largest.hh"
 
 #include <G4Box.hh>
 
 #include <G4EventManager.hh>
+#include <G4Gamma.hh>
 #include <G4LogicalVolumeStore.hh>
 #include <G4ParticleGun.hh>
+#include <G4RandomDirection.hh>
 #include <G4RunManager.hh>
 #include <G4String.hh>
 #include <G4SystemOfUnits.hh>
@@ -28,6 +33,10 @@
 
 #include <tuple>
 #include <algorithm>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
 
 // ----- Fundamental requirements of Geant4 --------------------------------------
 
@@ -282,3 +291,57 @@ TEST_CASE("trivial app", "[app]") {
   // Verify that all generated particles arrived at the detector
   CHECK(sd->detected_particles == expected_hits);
 }
+
+// The slowest events of a run are kept as the random engine state at the start
+// of their generation (as abracadabra does with /abracadabra/slowest_events),
+// saved to file, and replayed one by one: each replay must repeat its event.
+TEST_CASE("replay events from saved engine states", "[app][replay]") {
+  using steps = std::vector<G4ThreeVector>; // Where each step of an event ended
+  steps this_event;
+  engine_state state;
+  keep_largest<std::pair<engine_state, steps>, size_t> costliest{3}; // Most steps
+  bool replaying = false;
+
+  n4::generator::function shoot = [&state](G4Event* event) {
+    state = current_engine_state(); // Before any random numbers are used for the event
+    G4ParticleGun gun{1};
+    gun.SetParticleDefinition(G4Gamma::Definition());
+    gun.SetParticleEnergy(511*keV);
+    gun.SetParticleMomentumDirection(G4RandomDirection());
+    gun.GeneratePrimaryVertex(event);
+  };
+  n4::event_action::action_t begin_event = [&](auto) { this_event.clear(); };
+  n4::event_action::action_t   end_event = [&](auto) {
+    if (! replaying) { costliest.offer(this_event.size(), {state, this_event}); }
+  };
+  n4::stepping_action::action_t record = [&](auto step) {
+    this_event.push_back(step -> GetPostStepPoint() -> GetPosition());
+  };
+  n4::geometry::construct_fn water_box = [] {
+    auto water = nain4::material("G4_WATER");
+    return nain4::place(nain4::volume<G4Box>("replay_world", water, 20*cm, 20*cm, 20*cm)).now();
+  };
+
+  nain4::silence _{G4cout};
+  auto run_manager = G4RunManager::GetRunManager();
+  run_manager -> SetUserInitialization(new n4::geometry{water_box});
+  n4::use_our_optical_physics(run_manager);
+  run_manager -> SetUserInitialization((new n4::actions{shoot})
+                                       -> set((new n4::event_action) -> begin(begin_event) -> end(end_event))
+                                       -> set(new n4::stepping_action{record}));
+  run_manager -> Initialize();
+  run_manager -> BeamOn(20);
+
+  REQUIRE(costliest.size() == 3);
+  replaying = true;
+  auto file = std::string{std::tmpnam(nullptr)} + ".rndm";
+  for (auto& [n_steps, event] : costliest.sorted()) {
+    auto& [saved_state, original] = event;
+    save_engine_state(saved_state, file);
+    G4Random::restoreEngineStatus(file.c_str());
+    run_manager -> BeamOn(1);
+    CHECK(this_event.size() == n_steps);
+    CHECK(this_event        == original);
+  }
+  std::remove(file.c_str());
+}